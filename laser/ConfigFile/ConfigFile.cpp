@@ -23,7 +23,7 @@
 #include "ConfigFile.h"
 
 // Make new config file object
-ConfigFile::ConfigFile(char *file)
+ConfigFile::ConfigFile(const char *file)
 {
   printf("ConfigFile:ConfigFile (%s)\r\n", file);
   extern LaosFileSystem sd;
@@ -47,7 +47,7 @@ ConfigFile::~ConfigFile()
 }
 
 // Read value
-bool ConfigFile::Value(char *key, char *value,  size_t maxlen, char *def)
+bool ConfigFile::Value(const char *key, char *value,  size_t maxlen, const char *def)
 {
   int m=0,n=0,c,s=0;
   char *v = value;
@@ -94,13 +94,13 @@ bool ConfigFile::Value(char *key, char *value,  size_t maxlen, char *def)
         {
           s = 3;
           m = 1;
-          if ( m < maxlen)
+          if ( (size_t)m < maxlen)
             *value++ = c;
         }
         break;
 
       case 3: // copy value content, upto eol or comment
-        if ( m == maxlen || c == '\n' || c == '\r' || c == ';' )
+        if ( (size_t)m == maxlen || c == '\n' || c == '\r' || c == ';' )
           s = 99;
         else
         {
@@ -129,7 +129,7 @@ bool ConfigFile::Value(char *key, char *value,  size_t maxlen, char *def)
 
 
 // Read int value
-bool ConfigFile::Value(char *key, int *value, int def)
+bool ConfigFile::Value(const char *key, int *value, int def)
 {
   char val[64];
   bool b = Value(key, val, 64, "");
@@ -38,6 +38,186 @@ I2C i2c(p9, p10);        // sda, scl
 #define _I2C_CLS 0xFF
 #define _I2C_BAUD 9600
 
+// Display updates: the screen is kept in a frame buffer, a ticker sends the part that changed
+// (at most every _DISPLAY_PERIOD msec) in one I2C transaction, driven by the I2C interrupt.
+// The display only knows "home" and "next character", so a transaction starts at the cursor
+// (if that is before the first change) or at home, and ends at the last changed character.
+#define _DISPLAY_CELLS 32   // 2 lines of 16 characters
+#define _DISPLAY_PERIOD 50  // minimal time between updates [msec]
+
+// Keys: the same ticker reads the keypad every _KEY_PERIOD msec (also interrupt driven).
+// A key is accepted when _KEY_DEBOUNCE samples in a row are equal, key presses are queued.
+#define _TICK_PERIOD 10     // [msec]
+#define _KEY_PERIOD 20      // [msec]
+#define _KEY_DEBOUNCE 2     // [samples]
+#define _KEY_QUEUE 8
+#define _I2C_MAX_WRITE 32   // max bytes per transaction (receive buffer of the display)
+
+// I2C1 (p9, p10) control bits
+#define I2C_AA  0x04
+#define I2C_SI  0x08
+#define I2C_STO 0x10
+#define I2C_STA 0x20
+#define I2C_EN  0x40
+
+static char frame[_DISPLAY_CELLS];  // what should be on the display
+static char shown[_DISPLAY_CELLS];  // what is on the display
+static int cursor = -1;             // display cursor position after the last update (-1: unknown)
+static Ticker display_tick;
+static volatile char key_state = 0; // debounced key (0: none)
+static char key_queue[_KEY_QUEUE];  // key presses
+static volatile int key_head = 0, key_tail = 0;
+static volatile int i2c_busy = 0;   // transaction in progress
+static int i2c_read = 0;            // transaction reads a key
+static volatile int i2c_lock = 0;   // blocking I2C access in progress, no new transactions
+static char i2c_buf[_I2C_MAX_WRITE];
+static int i2c_len, i2c_pos;
+static int i2c_from, i2c_to;        // frame cells in the current transaction, i2c_from < 0: none
+
+// New key sample: debounce and queue the key presses
+static void key_sample(char key)
+{
+  static char last = 0;
+  static int stable = 0;
+  if ((key < '1') || (key > '9'))
+    key = 0;
+  if ( key != last )
+  {
+    last = key;
+    stable = 0;
+  }
+  if ( ++stable < _KEY_DEBOUNCE || key == key_state )
+    return;
+  key_state = key;
+  if ( key && (key_head + 1) % _KEY_QUEUE != key_tail )
+  {
+    key_queue[key_head] = key;
+    key_head = (key_head + 1) % _KEY_QUEUE;
+  }
+}
+
+// End of a transaction
+static void i2c_done(int error)
+{
+  i2c_read = 0;
+  if ( i2c_from >= 0 )
+  {
+    if ( error )
+      cursor = -1;
+    else
+    {
+      memcpy(shown + i2c_from, i2c_buf + i2c_len - (i2c_to - i2c_from), i2c_to - i2c_from);
+      cursor = i2c_to;
+    }
+  }
+  i2c_busy = 0;
+}
+
+// I2C state machine (master transmitter, or receiver of one key)
+static void i2c_irq()
+{
+  switch ( LPC_I2C1->I2STAT )
+  {
+    case 0x08: // start sent: send the address
+    case 0x10:
+      LPC_I2C1->I2DAT = (i2c_read ? _I2C_ADDRESS | 1 : _I2C_ADDRESS & ~1);
+      LPC_I2C1->I2CONCLR = I2C_STA;
+      break;
+    case 0x40: // read address acknowledged: receive one byte, no acknowledge
+      LPC_I2C1->I2CONCLR = I2C_AA;
+      break;
+    case 0x58: // key received
+      key_sample(LPC_I2C1->I2DAT);
+      LPC_I2C1->I2CONSET = I2C_STO;
+      i2c_done(0);
+      break;
+    case 0x18: // address or data sent and acknowledged: send the next byte
+    case 0x28:
+      if ( i2c_pos < i2c_len )
+        LPC_I2C1->I2DAT = i2c_buf[i2c_pos++];
+      else
+      {
+        LPC_I2C1->I2CONSET = I2C_STO;
+        i2c_done(0);
+      }
+      break;
+    default: // not acknowledged, arbitration lost or bus error
+      LPC_I2C1->I2CONSET = I2C_STO;
+      i2c_done(1);
+      break;
+  }
+  LPC_I2C1->I2CONCLR = I2C_SI;
+}
+
+// Send the changed part of the frame buffer
+static void display_update()
+{
+  int first, last, n;
+  for (first=0; first < _DISPLAY_CELLS && frame[first] == shown[first]; first++);
+  if ( first == _DISPLAY_CELLS )
+    return;
+  for (last=_DISPLAY_CELLS-1; frame[last] == shown[last]; last--);
+  n = 0;
+  i2c_read = 0;
+  if ( cursor < 0 || cursor > first )
+  {
+    i2c_buf[n++] = _I2C_HOME;
+    cursor = 0;
+  }
+  i2c_from = cursor;
+  i2c_to = last + 1;
+  if ( i2c_to - i2c_from > _I2C_MAX_WRITE - n ) // the rest follows in the next update
+    i2c_to = i2c_from + _I2C_MAX_WRITE - n;
+  memcpy(i2c_buf + n, frame + i2c_from, i2c_to - i2c_from);
+  i2c_len = n + i2c_to - i2c_from;
+  i2c_pos = 0;
+  i2c_busy = 1;
+  LPC_I2C1->I2CONSET = I2C_STA;
+}
+
+// Start reading the keypad
+static void key_update()
+{
+  i2c_read = 1;
+  i2c_from = -1;
+  i2c_busy = 1;
+  LPC_I2C1->I2CONSET = I2C_STA;
+}
+
+// Ticker: read the keys and update the display, one transaction at a time
+static void display_tick_irq()
+{
+  static int t_key = 0, t_display = 0;
+  t_key += _TICK_PERIOD;
+  t_display += _TICK_PERIOD;
+  if ( i2c_busy || i2c_lock )
+    return;
+  if ( t_key >= _KEY_PERIOD )
+  {
+    t_key = 0;
+    key_update();
+  }
+  else if ( t_display >= _DISPLAY_PERIOD )
+  {
+    t_display = 0;
+    display_update();
+  }
+}
+
+// Wait for the interrupt driven transaction to finish, and take the bus for a blocking I2C call
+static void i2c_begin()
+{
+  i2c_lock = 1;
+  while ( i2c_busy );
+  NVIC_DisableIRQ(I2C1_IRQn);
+}
+
+static void i2c_end()
+{
+  NVIC_EnableIRQ(I2C1_IRQn);
+  i2c_lock = 0;
+}
+
 // Make new config file object
 LaosDisplay::LaosDisplay()
 {
@@ -53,16 +233,28 @@ LaosDisplay::LaosDisplay()
   // wait 1 second to make sure that I2C has time to power on!
   wait(3);
   sim = i2c.read(_I2C_ADDRESS ,&key, 1) != 0;
+  memset(frame, ' ', sizeof(frame));
+  memset(shown, 0, sizeof(shown));
   if (sim) {
     printf("LaosDisplay()\r\n");
     printf("Display() Simulation=ON, I2C Baudrate=%d\r\n", i2cBaud  );
+  } else {
+    i2c_from = -1;
+    LPC_I2C1->I2CONSET = I2C_EN;
+    NVIC_SetVector(I2C1_IRQn, (uint32_t)(uintptr_t)&i2c_irq);
+    NVIC_SetPriority(I2C1_IRQn, 31); // lowest: never delay the step interrupt
+    NVIC_EnableIRQ(I2C1_IRQn);
+    display_tick.attach_us(&display_tick_irq, _TICK_PERIOD * 1000);
   }
 }
 
 // Test I2C again when config file is read
 void LaosDisplay::testI2C() {
     char key;
+    if (sim) mbed_reset();
+    i2c_begin();
     sim = i2c.read(_I2C_ADDRESS ,&key, 1) != 0;
+    i2c_end();
     if (sim) mbed_reset();
 }
 
@@ -79,18 +271,25 @@ void LaosDisplay::write(char *s)
 #endif
     return;
   } else {
-    while (*s)
-      i2c.write(_I2C_ADDRESS, s++, 1);
+    i2c_begin();
+    i2c.write(_I2C_ADDRESS, s, strlen(s));
+    cursor = -1; // the frame buffer does not know what we wrote
+    memset(shown, 0, sizeof(shown));
+    i2c_end();
   }
 }
 
 // Clear screen
 void LaosDisplay::cls()
 {
-   char s[2];
-   s[0] = _I2C_HOME;
-   s[1] = 0;
-   write(s);
+   memset(frame, ' ', sizeof(frame));
+   if ( sim )
+   {
+     char s[2];
+     s[0] = _I2C_HOME;
+     s[1] = 0;
+     write(s);
+   }
 }
 
 // Read Key
@@ -107,12 +306,25 @@ int LaosDisplay::read()
       key = 0;
   }
   else
-    i2c.read(_I2C_ADDRESS ,&key, 1);
+    key = key_state;
   if ((key < '1') || (key > '9'))
     key = 0;
   return key;
 }
 
+// Next key press from the queue
+int LaosDisplay::getkey()
+{
+  char key;
+  if ( sim )
+    return read();
+  if ( key_tail == key_head )
+    return 0;
+  key = key_queue[key_tail];
+  key_tail = (key_tail + 1) % _KEY_QUEUE;
+  return key;
+}
+
 /**
 *** Screens are defined with:
 *** name, line[2], int* i[4], char *s;
@@ -133,10 +345,11 @@ inline char digit(int i, int n)
   return c;
 }
 
-void LaosDisplay::ShowScreen(const char *l, int *arg, char *s)
+void LaosDisplay::ShowScreen(const char *l, int *arg, const char *s)
 {
   char c, next=0,surpress=1;
   char str[128],*p;
+  int n;
   p = str;
   *p++ = _I2C_HOME;
   while ( *l )
@@ -183,7 +396,18 @@ void LaosDisplay::ShowScreen(const char *l, int *arg, char *s)
     l++;
   }
   *p=0;
-  write(str);
+
+  // only the changes go to the display
+  n = p - str - 1;
+  while ( n < _DISPLAY_CELLS ) str[1 + n++] = ' ';
+  str[1 + n] = 0;
+  if ( sim )
+  {
+    if ( !memcmp(frame, str+1, _DISPLAY_CELLS) )
+      return;
+    write(str);
+  }
+  memcpy(frame, str+1, _DISPLAY_CELLS);
 }
 
 // EOF
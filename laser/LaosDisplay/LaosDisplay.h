@@ -45,7 +45,7 @@ public:
   * @param s The string to display
   */
   void write(char *s);
-  void ShowScreen(const char *l, int *arg, char *s);
+  void ShowScreen(const char *l, int *arg, const char *s);
   void testI2C();
 
 
@@ -58,6 +58,11 @@ public:
   */
   int read();
 
+/** Next key press (non blocking), presses are queued between calls
+  * @return (ASCII) character value, zero if no key was pressed
+  */
+  int getkey();
+
 private:
   bool sim;
   int i2cBaud;
@@ -32,7 +32,7 @@ LaosFileSystem::LaosFileSystem(PinName mosi, PinName miso, PinName sclk, PinName
 LaosFileSystem::~LaosFileSystem() {
 }
 
-FILE* LaosFileSystem::openfile(char *name, char* iom) {
+FILE* LaosFileSystem::openfile(const char *name, const char* iom) {
     if (islegalname(name)) {  // check length and chars in name
 
         char shortname[SHORTFILESIZE] = "";
@@ -78,7 +78,7 @@ void LaosFileSystem::getlongname(char *result, char *searchname) {
     }
 }
 
-int LaosFileSystem::islegalname(char* name) {
+int LaosFileSystem::islegalname(const char* name) {
     if (( strlen(name) > MAXFILESIZE-1 ) || (strlen(name) == 0))
         return 0;
     int legal = 1;
@@ -94,7 +94,7 @@ int LaosFileSystem::islegalname(char* name) {
     return legal;
 }
 
-int LaosFileSystem::isshortname(char* name) {
+int LaosFileSystem::isshortname(const char* name) {
     int len = strlen(name);
     for (int x=0; x<len; x++)
         if (name[x] == ' ') return 0; // spaces not allowed in shortname
@@ -108,7 +108,7 @@ int LaosFileSystem::isshortname(char* name) {
             return 0;    // basename was too long
         } else {
             if (char *ext_name = strtok(NULL, ".")) {  //
-                if ((strlen(basename)+strlen(ext_name)+1) == len) {
+                if ((int)(strlen(basename)+strlen(ext_name)+1) == len) {
                     if (strlen(ext_name)<4) {
                         return 1; // filename is in 8.3 format
                     } else {
@@ -131,16 +131,16 @@ void LaosFileSystem::removespaces(char* name) {
     while (spaces) {
         spaces = 0;
         int x = 0;
-        while ((name[x] != ' ') && (x<strlen(name))) x++;
+        while ((name[x] != ' ') && (name[x] != 0)) x++;
         if (name[x] == ' ') {
             spaces = 1;
-            for (int y = x; x<(strlen(name)-1); y++)
+            for (int y = x; name[y] != 0; y++)
                 name[y] = name[y+1];
         }
     }
 }
 
-void LaosFileSystem::getshortname(char* shortname, char* name) {
+void LaosFileSystem::getshortname(char* shortname, const char* name) {
     // * open filename translation table
     // * and see if a file with that name exists
     if (isshortname(name)) {
@@ -162,7 +162,7 @@ void LaosFileSystem::getshortname(char* shortname, char* name) {
     }
 }
 
-void LaosFileSystem::makeshortname(char* shortname, char* name) {
+void LaosFileSystem::makeshortname(char* shortname, const char* name) {
     char *tmpname = new char[MAXFILESIZE];
     strcpy(tmpname, name);
     removespaces(tmpname);
@@ -191,7 +191,7 @@ void LaosFileSystem::makeshortname(char* shortname, char* name) {
     dirwrite(name, shortname, tfp);
     fclose(tfp);
 
-    delete(tmpname);
+    delete[] tmpname;
 }
 
 void LaosFileSystem::cleanlist() {
@@ -266,13 +266,13 @@ size_t LaosFileSystem::dirread(char* longname, char* shortname, FILE *fp) {
     return result;
 }
 
-size_t LaosFileSystem::dirwrite(char* longname, char* shortname, FILE* fp) {
+size_t LaosFileSystem::dirwrite(const char* longname, const char* shortname, FILE* fp) {
     char buff[MAXFILESIZE+SHORTFILESIZE];
     int x=0; 
-    while (longname[x] != 0) buff[x++] = longname[x];
+    while (longname[x] != 0) { buff[x] = longname[x]; x++; }
     while (x<MAXFILESIZE-1) buff[x++] = ' ';
     buff[x++] = '\t';
-    while (shortname[x-MAXFILESIZE] != 0) buff[x++] = shortname[x-MAXFILESIZE];
+    while (shortname[x-MAXFILESIZE] != 0) { buff[x] = shortname[x-MAXFILESIZE]; x++; }
     while (x<MAXFILESIZE+SHORTFILESIZE-1) buff[x++] = ' ';
     buff[x++] = '\n';
     
@@ -298,14 +298,19 @@ void cleandir() {
     if(d != NULL) {
         while((p = readdir(d)) != NULL) {
             char fullname[MAXFILESIZE+SHORTFILESIZE+2];
-            sprintf(fullname, "/sd/%s", p->d_name);
-            remove(fullname);
+            if (snprintf(fullname, sizeof(fullname), "/sd/%s", p->d_name) < (int)sizeof(fullname))
+                remove(fullname);
         }
     } else {
         error("Could not open directory!\n\r");
     }
 }
 
+int issysfile(char *name) {
+    return !strncmp(name, "longname.sy", 11) || !strcmp(name, _LAOSFILE_CHECKPOINT) || !strcmp(name, _LAOSFILE_STATS)
+        || !strcmp(name, _LAOSFILE_JOBLOG);
+}
+
 void printdir() {
     extern LaosFileSystem sd;
     printf("List of files in /sd\n\r");
@@ -316,7 +321,7 @@ void printdir() {
         // printf("...\n\r");
         while((p = readdir(d)) != NULL) {
             // printf("Short %s\n\r", p->d_name);
-            if (strncmp(p->d_name, "longname.sy",11)) {
+            if (!issysfile(p->d_name)) {
                 char longname[MAXFILESIZE];
                 // printf("Getlongname\n\r");
                 sd.getlongname(longname, p->d_name);
@@ -338,7 +343,7 @@ void getprevjob(char *name) {
     d = opendir("/sd");
     if(d != NULL) {
         while((p = readdir(d)) != NULL) {
-            if (strncmp(p->d_name, "longname.sy",11)) { // skip longname.sy*
+            if (!issysfile(p->d_name)) { // skip longname.sy* and the checkpoint
                 if (! strcmp(shortname, p->d_name)) {   // shortname = current entry
                     if (strcmp(last, "")) {
                         sd.getlongname(name, last);     // return entry before
@@ -369,7 +374,7 @@ void getnextjob(char *name) {
     d = opendir("/sd");
     if(d != NULL) {
         while((p = readdir(d)) != NULL) {
-            if (strncmp(p->d_name, "longname.sy",11)) { // skip longname.sy*
+            if (!issysfile(p->d_name)) { // skip longname.sy* and the checkpoint
                 if (! strcmp(shortname, last)) {        // if last was shortname
                     sd.getlongname(name, p->d_name);    //    return current
                     closedir(d);
@@ -447,7 +452,7 @@ void writefile(char *myfile) {
     } 
 }
 
-void removefile(char *name) {
+void removefile(const char *name) {
     extern LaosFileSystem sd;
     char shortname[SHORTFILESIZE] = "";
     sd.getshortname(shortname, name);
@@ -506,7 +511,7 @@ int readint(FILE *fp)
 } // read integer
 
 void strtolower(char *name) {
-    for(int i = 0; i < strlen(name); i++)
+    for(int i = 0; name[i] != 0; i++)
         name[i] = tolower(name[i]);
 }
 
@@ -547,8 +552,8 @@ void removeFirmware() { // remove old firmware from SD
         while((p = readdir(d)) != NULL) {
             if (isFirmware(p->d_name)) {
                 char name[32];
-                sprintf(name, "/local/%s", p->d_name);
-                remove(name);
+                if (snprintf(name, sizeof(name), "/local/%s", p->d_name) < (int)sizeof(name))
+                    remove(name);
             } 
         }
     } else {
@@ -29,6 +29,9 @@
 #include <ctype.h>
 
 #define _LAOSFILE_TRANSTABLE "longname.sys"
+#define _LAOSFILE_CHECKPOINT "checkpnt.sys"
+#define _LAOSFILE_STATS "stats.txt"
+#define _LAOSFILE_JOBLOG "joblog.csv"
 #define MAXFILESIZE 21
 #define SHORTFILESIZE 13
 
@@ -37,20 +40,20 @@ class LaosFileSystem : public SDFileSystem {
         LaosFileSystem(PinName mosi, PinName miso, PinName sclk, PinName cs, 
                 const char* name);        // Create the filesystem on SD
         virtual ~LaosFileSystem();                // destructor
-        FILE* openfile(char* fname, char* iom);    // open a file
+        FILE* openfile(const char* fname, const char* iom);    // open a file
         void getlongname(char *result, char *searchname);   // return long names
-        void getshortname(char* shortname, char* name); //get a short name
+        void getshortname(char* shortname, const char* name); //get a short name
         char pathname[MAXFILESIZE+2];
         void cleanlist();
         void shorten(char* name, int max);
         
     private:
-        int islegalname(char* name);
-        int isshortname(char* name);
+        int islegalname(const char* name);
+        int isshortname(const char* name);
         void removespaces(char* name);
-        void makeshortname(char* shortname, char* name);
+        void makeshortname(char* shortname, const char* name);
         size_t dirread(char* longname, char* shortname, FILE *fp);
-        size_t dirwrite(char* longname, char* shortname, FILE* fp);
+        size_t dirwrite(const char* longname, const char* shortname, FILE* fp);
         char tablename[MAXFILESIZE + SHORTFILESIZE + 1];
 };
 
@@ -62,7 +65,7 @@ void printdir();        // list all files in directory (with long names)
 void getprevjob(char *name);     // previous job
 void getnextjob(char *name);     // next job
 void writefile(char *name); // example code to open a file
-void removefile(char *name);    // example code to remove a file
+void removefile(const char *name);    // example code to remove a file
 int readint(FILE *fp);      // read integers from open file
 void strtolower(char *name);    // change characters to lowercase
 int isFirmware(char *name);     // check if it's firmware
@@ -70,4 +73,5 @@ void installFirmware(char *filename); // put firmware in place
 void removeFirmware(); // remove old firmware
 int SDcheckFirmware();  // check for firmware
 int isLaosFile(char *filename);   // check extension for LaOS compatibility
+int issysfile(char *name);  // longname table, job checkpoint, job summary or job log (not a job)
 #endif
@@ -0,0 +1,97 @@
+/**
+ * LaosJobLog.cpp
+ * Job history: one line per job in a CSV file on SD
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "LaosJobLog.h"
+#include "laosfilesystem.h"
+
+extern LaosFileSystem sd;
+
+static tJobRecord pending[JOBLOG_PENDING];
+static int npending = 0;
+static int running = 0; // a job is running: do not write
+static uint32_t lost = 0;
+static uint32_t start, size;
+
+static const char *results[] = { "done", "canceled", "endstop" };
+
+/**
+*** A job starts
+**/
+void joblog_start(uint32_t filesize)
+{
+  start = time(NULL);
+  size = filesize;
+  running = 1;
+}
+
+/**
+*** The job ended: keep the record until the log is written
+**/
+void joblog_end(tJobRecord *rec)
+{
+  running = 0;
+  if ( npending >= JOBLOG_PENDING )
+  {
+    lost++;
+    return;
+  }
+  rec->start = start;
+  rec->size = size;
+  rec->actual = time(NULL) - start;
+  pending[npending++] = *rec;
+}
+
+/**
+*** Append the pending records to the log (create it with a header line if needed)
+**/
+void joblog_flush()
+{
+  FILE *fp;
+  int header = 0;
+  if ( running || (npending == 0 && lost == 0) )
+    return;
+  fp = sd.openfile((char*)_LAOSFILE_JOBLOG, (char*)"rb");
+  if ( fp )
+    fclose(fp);
+  else
+    header = 1;
+  fp = sd.openfile((char*)_LAOSFILE_JOBLOG, (char*)"ab");
+  if ( fp == NULL )
+    return;
+  if ( header )
+    fprintf(fp, "start,name,size,estimated,actual,laser,underruns,blocks,result\r\n");
+  for (int i=0; i<npending; i++)
+  {
+    tJobRecord *r = &pending[i];
+    fprintf(fp, "%lu,\"%s\",%lu,%.1f,%.1f,%.1f,%lu,%lu,%s\r\n", (unsigned long)r->start, r->name,
+      (unsigned long)r->size, r->est, r->actual, r->laser, (unsigned long)r->underruns,
+      (unsigned long)r->blocks, results[r->result]);
+  }
+  if ( lost )
+    fprintf(fp, ",,,,,,,,%lu records lost\r\n", (unsigned long)lost);
+  fclose(fp);
+  npending = 0;
+  lost = 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * LaosJobLog.h
+ * Job history: one line per job in a CSV file on SD
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * joblog_start() and joblog_end() mark a job, the record of the job is kept in RAM.
+ * The "joblog" task appends the records to joblog.csv when no job is running,
+ * so the SD card is never written while a job is read from it.
+ * The log is fetched with a TFTP GET of joblog.csv.
+ *
+ @code
+   joblog_start(size);
+   ... run the job
+   joblog_end(&rec);
+ @endcode
+ */
+#ifndef _LAOSJOBLOG_H_
+#define _LAOSJOBLOG_H_
+#include <stdint.h>
+
+#define JOBLOG_PENDING 4 // records kept in RAM until they are written
+#define JOBLOG_NAME 32
+
+// result of a job
+enum { JOB_DONE, JOB_CANCELED, JOB_ENDSTOP };
+
+typedef struct {
+  char name[JOBLOG_NAME];
+  uint32_t start;     // start time [sec, RTC]
+  uint32_t size;      // job file size [bytes]
+  float est;          // estimated duration [sec]
+  float actual;       // actual duration [sec]
+  float laser;        // laser on time [sec]
+  uint32_t underruns; // planner queue underruns
+  uint32_t blocks;    // executed blocks
+  int result;         // JOB_DONE, ...
+} tJobRecord;
+
+void joblog_start(uint32_t size); // a job starts: set the start time and size
+void joblog_end(tJobRecord *rec); // the job ended: add the record (name, counters and result filled in)
+void joblog_flush(); // scheduler task: write the records when no job is running
+
+#endif
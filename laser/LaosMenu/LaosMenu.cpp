@@ -36,6 +36,8 @@ static const char *menus[] = {
     "REMOVE ALL JOBS", //10
     "IP",          //11
     "REBOOT", //12
+    "RESUME JOB", //13
+    "DIAGNOSTICS", //14
     // "POWER / SPEED",//13
     // "IO", //14
 };
@@ -96,7 +98,15 @@ static const char *screens[] = {
     "REBOOTING...    "
     "Please wait...  ",
 
-#define POWER (REBOOT+1)
+#define RESUME (REBOOT+1)
+    "RESUME:         "
+    "$$$$$$$$$$$$$$$$",
+
+#define DIAG (RESUME+1)
+    "$$$$$$$$$$$$$$$$"
+    "+9876543210 [ok]",
+
+#define POWER (DIAG+1)
     "$$$$$$$: 6543210"
     "      [ok]      ",
 
@@ -153,15 +163,67 @@ static const char *screens[] = {
 };
 
 static  const char *ipfields[] = { "IP", "NETMASK", "GATEWAY", "DNS" };
+static  const char *diagfields[] = { "BLOCKS", "UNDERRUNS", "QUEUE FULL", "ISR REENTRIES", "ISR MAX [usec]", "STEPS/SEC MAX" };
 //static  const char *powerfields[] = { "Pmin %", "Pmax %", "Voff", "Von" };
 //static  const char *iofields[] = { "o1:PURGE", "o2:EXHAUST", "o3:PUMP", "i1:COVER", "i2:PUMPOK", "i3:LASEROK", "i4:PURGEOK" };
 
 
+static Timer checkpointtimer; // time since the last job checkpoint was written
+
+/**
+*** Full name of the job checkpoint file on the SD card
+**/
+static void checkpointname(char *name) {
+    extern LaosFileSystem sd;
+    sprintf(name, "%s%s", sd.pathname, _LAOSFILE_CHECKPOINT);
+}
+
+/**
+*** Start of a job: reset the counters, note the size of the job file
+**/
+void jobStart(FILE *fp) {
+    long pos = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    joblog_start(ftell(fp));
+    fseek(fp, pos, SEEK_SET);
+    mot->resetStats();
+}
+
+/**
+*** Job summary: print the motion counters, and save them on SD (get them with TFTP as stats.txt)
+*** The job is added to the job log (joblog.csv)
+**/
+void jobSummary(char *name, int result) {
+    extern LaosFileSystem sd;
+    tMotionStats st;
+    tJobRecord rec;
+    mot->getStats(&st);
+    strncpy(rec.name, name, JOBLOG_NAME-1);
+    rec.name[JOBLOG_NAME-1] = 0;
+    rec.est = st.est_time;
+    rec.laser = st.laser_ms / 1000.0;
+    rec.underruns = st.underruns;
+    rec.blocks = st.blocks;
+    rec.result = result;
+    joblog_end(&rec);
+    printf("Job %s: %s\r\n", (result == JOB_DONE ? "done" : "stopped"), name);
+    mot->printStats(stdout);
+    prof_report(stdout);
+    FILE *fp = sd.openfile((char*)_LAOSFILE_STATS, (char*)"wb");
+    if ( fp ) {
+        fprintf(fp, "job: %s\r\n", name);
+        mot->printStats(fp);
+        prof_report(fp);
+        fclose(fp);
+    }
+}
+
 /**
 *** Make new menu object
 **/
 LaosMenu::LaosMenu(LaosDisplay *display) {
-    waitup=timeout=iofield=ipfield=0;
+    waitup=timeout=iofield=ipfield=diagfield=0;
+    canceled=skipped=0;
     sarg = NULL;
     x=y=z=0;
     xoff=yoff=zoff=0;
@@ -171,7 +233,7 @@ LaosMenu::LaosMenu(LaosDisplay *display) {
     dsp = display;
     if ( dsp == NULL ) dsp = new LaosDisplay();
     dsp->cls();
-    SetScreen(NULL);
+    SetScreen((const char*)NULL);
     runfile = NULL;
 }
 
@@ -195,7 +257,7 @@ void LaosMenu::SetScreen(int screen) {
 /**
 *** Goto specific screen
 **/
-void LaosMenu::SetScreen(char *msg) {
+void LaosMenu::SetScreen(const char *msg) {
     if ( msg == NULL ) {
         sarg = NULL;
         screen = MAIN;
@@ -211,9 +273,69 @@ void LaosMenu::SetScreen(char *msg) {
     Handle();
 }
 
+/**
+*** Pause the running job: the motion decelerates to a stop (feed hold),
+*** the queue and the job file are kept so the job can be resumed
+**/
+void LaosMenu::pauseJob() {
+    mot->hold();
+    lastscreen = screen;
+    screen = PAUSE;
+    sarg = jobname;
+    canceled = 1; // leave the job loops, the job file stays open
+    printf("pause...\r\n");
+}
+
+/**
+*** Write the latest job checkpoint to SD, at most once every cfg->checkpoint seconds
+*** and only while the motion queue is full (so it does not slow down the job)
+**/
+void LaosMenu::saveCheckpoint() {
+    static tCheckpoint cp;
+    static int fresh = 0;
+    char name[MAXFILESIZE+SHORTFILESIZE+2];
+    if ( !cfg->checkpoint ) return;
+    if ( mot->checkpoint(&cp) ) fresh = 1;
+    if ( !fresh || mot->ready() || checkpointtimer.read() < cfg->checkpoint ) return;
+    checkpointname(name);
+    FILE *fp = fopen(name, "w");
+    if ( fp ) {
+        fprintf(fp, "%s\n%d %ld %d %d %d %d %d %d %d %d\n", jobname, cp.words, cp.offset, cp.power, cp.speed,
+            cp.ppi, cp.pulse, cp.blend, cp.ofsx, cp.ofsy, cp.ofsz);
+        fclose(fp);
+    }
+    fresh = 0;
+    checkpointtimer.reset();
+}
+
+/**
+*** Read the job checkpoint from SD (job name in resumejob). Returns 1 if there is one.
+**/
+int LaosMenu::loadCheckpoint() {
+    char name[MAXFILESIZE+SHORTFILESIZE+2];
+    int n = 0;
+    strcpy(resumejob, "");
+    checkpointname(name);
+    FILE *fp = fopen(name, "r");
+    if ( fp == NULL ) return 0;
+    if ( fgets(resumejob, sizeof(resumejob), fp) ) {
+        resumejob[strcspn(resumejob, "\r\n")] = 0;
+        n = fscanf(fp, "%d %ld %d %d %d %d %d %d %d %d", &resumecp.words, &resumecp.offset, &resumecp.power,
+            &resumecp.speed, &resumecp.ppi, &resumecp.pulse, &resumecp.blend, &resumecp.ofsx, &resumecp.ofsy,
+            &resumecp.ofsz);
+    }
+    fclose(fp);
+    if ( n != 10 ) strcpy(resumejob, "");
+    return strlen(resumejob) > 0;
+}
+
 void LaosMenu::checkCancel() {
-    c = dsp->read();
-    if(c==K_CANCEL || !mot->isStart() || mot->endstopReached()){
+    c = dsp->getkey(); // a short key press in between counts too
+    if (!c) c = dsp->read();
+    if((c==K_CANCEL || !mot->isStart()) && !mot->endstopReached() && (screen == RUNNING || screen == TESTING)){
+        pauseJob();
+    } else if(c==K_CANCEL || !mot->isStart() || mot->endstopReached()){
+        if (screen == RUNNING) jobSummary(jobname, mot->endstopReached() ? JOB_ENDSTOP : JOB_CANCELED);
         fclose(runfile);
         runfile = NULL;
         screen = MAIN;
@@ -237,18 +359,18 @@ void LaosMenu::doHoming(int force){
     x = cfg->xhome;
     y = cfg->yhome;
     z = cfg->zhome;
-    while ( !mot->isStart() );
+    while ( !mot->isStart() ) sched_run();
     printf("disable safety...\r\n");
     mot->overrideSafety(true);
     mot->home(cfg->xhome,cfg->yhome,cfg->zhome);
     mot->getPosition(&x, &y, &z);
-    while(!mot->ready());
+    while(!mot->ready()) sched_run();
     if(mot->isHome){
         printf("resting...\r\n");
         mot->moveTo(cfg->xrest, cfg->yrest, cfg->zrest);
         printf("resting finished...\r\n");
     }
-    while(mot->queue()>0);
+    while(mot->queue()>0) sched_run();
     printf("reenable safety...\r\n");
     mot->overrideSafety(false);
     screen = lastscreen;
@@ -260,17 +382,23 @@ void LaosMenu::doHoming(int force){
 *** something changed
 **/
 void LaosMenu::Handle() {
-    if (!mot->isStart()){
-        mot->isHome=false;
-        screen=LIDOPEN;
-    }
-    if(screen==LIDOPEN && mot->isStart()){
-        screen=MAIN;
-    }
-    if(mot->endstopReached()){
-        screen=ENDSTOP;
+    if (mot != NULL) { // the boot messages are shown before the config is read and the motion exists
+        if (!mot->isStart()){
+            if (runfile != NULL && (screen == RUNNING || screen == TESTING)) {
+                pauseJob();
+            } else if (screen != PAUSE) {
+                mot->isHome=false;
+                screen=LIDOPEN;
+            }
+        }
+        if(screen==LIDOPEN && mot->isStart()){
+            screen=MAIN;
+        }
+        if(mot->endstopReached()){
+            screen=ENDSTOP;
+        }
     }
-    int xt, yt, zt, cnt=0, nodisplay = 0;
+    int zt, nodisplay = 0;
     extern LaosFileSystem sd;
     static int count=0;
 
@@ -292,7 +420,7 @@ void LaosMenu::Handle() {
         if ( speed >= 100 ) speed = 100;
     }
 
-    if ( c || screen != prevscreen || count >9 ) {
+    if ( c || screen != prevscreen || count >9 || (runfile != NULL && (screen == RUNNING || screen == TESTING)) ) {
 
         switch ( screen ) {
             case STARTUP:
@@ -356,6 +484,7 @@ void LaosMenu::Handle() {
 
             case FOCUS: // focus
                 mot->getPosition(&x, &y, &z);
+                zt = z; // only move when a key changed z
                 switch ( c ) {
                     case K_FUP: z+=speed; if (z>cfg->zmax) z=cfg->zmax; break;
                     case K_FDOWN: z-=speed; if (z<0) z=0; break;
@@ -432,10 +561,56 @@ void LaosMenu::Handle() {
                 }
                 break;
 
+            case DIAG: // motion counters (since the start of the last job)
+                switch ( c ) {
+                    case K_RIGHT: diagfield++; waitup=1; break;
+                    case K_LEFT: diagfield += 5; waitup=1; break;
+                    case K_OK: screen=MAIN; menu=MAIN; break;
+                    case K_CANCEL: screen=MAIN; menu=MAIN; break;
+                }
+                diagfield %= 6;
+                sarg = (char*)diagfields[diagfield];
+                {
+                    tMotionStats st;
+                    mot->getStats(&st);
+                    switch (diagfield) {
+                        case 0: args[0] = st.blocks; break;
+                        case 1: args[0] = st.underruns; break;
+                        case 2: args[0] = st.queue_full; break;
+                        case 3: args[0] = st.reentries; break;
+                        case 4: args[0] = st.isr_max / (SystemCoreClock / 1000000); break;
+                        case 5: args[0] = st.rate_max; break;
+                    }
+                }
+                break;
+
             case REBOOT: // RESET MACHINE
                 mbed_reset();
                 break;
 
+            case RESUME: // resume the last interrupted job from its checkpoint
+                if ( screen != prevscreen ) loadCheckpoint();
+                switch ( c ) {
+                    case K_OK:
+                        if ( strlen(resumejob) == 0 ) { screen=MAIN; break; }
+                        runfile = sd.openfile(resumejob, "rb");
+                        if ( !runfile ) { screen=MAIN; break; }
+                        strcpy(jobname, resumejob);
+                        doHoming(1); // the position may be lost
+                        mot->reset();
+                        fseek(runfile, resumecp.offset, SEEK_SET);
+                        mot->restore(&resumecp);
+                        jobStart(runfile);
+                        while ( dsp->getkey() ); // forget older key presses
+                        checkpointtimer.reset();
+                        checkpointtimer.start();
+                        screen=RUNNING;
+                        break;
+                    case K_CANCEL: screen=MAIN; menu=MAIN; waitup=1; break;
+                }
+                sarg = ( strlen(resumejob) ? resumejob : (char*)"NO CHECKPOINT" );
+                break;
+
 /*
             case IO: // IO
                 switch ( c ) {
@@ -485,8 +660,10 @@ void LaosMenu::Handle() {
                             runfile = sd.openfile(jobname, "rb");
                             if (! runfile)
                               screen=MAIN;
-                            else
+                            else {
                                mot->reset();
+                               while ( dsp->getkey() ); // forget older key presses
+                            }
                         } else {
                             canceled=0;
                             skipped=0;
@@ -501,6 +678,7 @@ void LaosMenu::Handle() {
                             }
                             while(!skipped && !canceled && mot->queue()>0){
                                 checkCancel();
+                                sched_run();
                             }
                             if (!canceled && feof(runfile) && mot->ready() && screen!=WARN) {
                                 fclose(runfile);
@@ -532,19 +710,31 @@ void LaosMenu::Handle() {
                                     screen=MAIN;
                                 } else {
                                     mot->reset();
+                                    jobStart(runfile);
+                                    while ( dsp->getkey() ); // forget older key presses
+                                    checkpointtimer.reset();
+                                    checkpointtimer.start();
                                 }
                              } else {
                                 canceled=0;
+                                checkCancel();
                                 while (!canceled && ((!feof(runfile)) && mot->ready())){
                                     checkCancel();
+                                    mot->setJobOffset(ftell(runfile));
                                     mot->write(readint(runfile),MODE_RUN);
                                 }
-                                while(!canceled && mot->queue()>0){
+                                if (!canceled) saveCheckpoint();
+                                while(!canceled && feof(runfile) && mot->queue()>0){
                                     checkCancel();
+                                    sched_run();
                                 }
                                 if (!canceled && feof(runfile) && mot->ready()) {
+                                    char name[MAXFILESIZE+SHORTFILESIZE+2];
+                                    checkpointname(name);
+                                    remove(name); // job done, nothing to resume
                                     fclose(runfile);
                                     runfile = NULL;
+                                    jobSummary(jobname, JOB_DONE);
                                     mot->moveTo(cfg->xrest, cfg->yrest, cfg->zrest);
                                     screen=MAIN;
                                 } else {
@@ -557,6 +747,27 @@ void LaosMenu::Handle() {
                 }
                 break;
 
+            case PAUSE: // job paused by a feed hold: continue or cancel
+                switch ( c ) {
+                    case K_OK:
+                        if ( mot->isStart() ) {
+                            mot->resume();
+                            screen = lastscreen;
+                        }
+                        break;
+                    case K_CANCEL:
+                        if ( runfile != NULL ) fclose(runfile);
+                        runfile = NULL;
+                        if ( lastscreen == RUNNING ) jobSummary(jobname, JOB_CANCELED);
+                        while ( !mot->isHeld() ) sched_run(); // still decelerating
+                        mot->clearBuffer();
+                        mot->reset();
+                        screen = MAIN;
+                        break;
+                }
+                sarg = jobname;
+                break;
+
             case LIDOPEN:
                 break;
             case ENDSTOP:
@@ -582,15 +793,18 @@ void LaosMenu::Handle() {
                                     screen=MAIN;
                                 } else {
                                     mot->reset();
+                                    while ( dsp->getkey() ); // forget older key presses
                                 }
                              } else {
                                 canceled=0;
+                                checkCancel();
                                 while (!canceled && ((!feof(runfile)) && mot->ready())){
                                     checkCancel();
                                     mot->write(readint(runfile),MODE_TEST);
                                 }
-                                while(!canceled && mot->queue()>0){
+                                while(!canceled && feof(runfile) && mot->queue()>0){
                                     checkCancel();
+                                    sched_run();
                                 }
                                 if (!canceled && feof(runfile) && mot->ready()) {
                                     fclose(runfile);
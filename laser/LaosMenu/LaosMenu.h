@@ -30,6 +30,9 @@
 #include "global.h"
 #include "LaosDisplay.h"
 #include "laosfilesystem.h"
+#include "LaosSched.h"
+#include "LaosProf.h"
+#include "LaosJobLog.h"
 extern "C" void mbed_reset();
 
     /** Menu system
@@ -46,6 +49,9 @@ extern void plan_get_current_position_xyz(float *x, float *y, float *z);
 
 extern LaosMotion *mot;
 
+void jobStart(FILE *fp); // reset the motion counters and start the job log record
+void jobSummary(char *name, int result); // write the motion counters of a finished job to serial and SD, log the job
+
 class LaosMenu {
 
 public:
@@ -60,33 +66,38 @@ public:
   void Handle();
   void doHoming(int force);
   void SetScreen(int screen);
-  void SetScreen(char *s);
+  void SetScreen(const char *s);
   void SetFileName(char * name);
   void checkCancel();
+  void pauseJob();
+  void saveCheckpoint();
+  int loadCheckpoint();
 
 private:
   // LaosDisplay *display;
   int args[5];
   unsigned char waitup, timeout;
-  char *sarg;
+  const char *sarg;
   int speed;
   char jobname[MAXFILESIZE];
 
   // input character
   int c;
 
-  int canceled=0;
-  int skipped=0;
+  int canceled;
+  int skipped;
 
   // menu states
   int screen, prevscreen, lastscreen, nextscreen;
-  unsigned char menu, ipfield, iofield;
+  unsigned char menu, ipfield, iofield, diagfield;
   unsigned char powerfield, power[4];
   LaosDisplay *dsp;
   int x,y,z;
   int xoff, yoff, zoff;
   int oldaccel;
   FILE *runfile;
+  tCheckpoint resumecp; // checkpoint of the job to resume
+  char resumejob[MAXFILESIZE];
 
 };
 
@@ -27,16 +27,18 @@
 #include  "planner.h"
 #include  "stepper.h"
 #include  "pins.h"
+#include "LaosSched.h"
+#include "LaosTrace.h"
+#include "LaosProf.h"
 
 // #define DO_MOTION_TEST 1
 
 // status leds
 extern DigitalOut led1,led2,led3,led4;
+extern LaosDisplay *dsp;
 
 bool endstopreached=false;
 
-static Ticker timer; // the periodic timer used to step
-
 // Inputs;
 DigitalIn xhome(p8);
 DigitalIn yhome(p17);
@@ -72,9 +74,6 @@ DigitalIn cover(p19);
 // globals
 int step=0, command=0;
 int mark_speed = 100; // 100 [mm/sec]
-int counter;
-int steps;
-int interrupt_busy=0;
 
 // next planner action to enqueue
 tActionRequest  action;
@@ -84,6 +83,14 @@ static int ofsx=0, ofsy=0, ofsz=0;
 
 // Command interpreter
 int param=0, val=0;
+static int power=10000;
+static int words=0; // nr of words written since reset()
+static long job_offset=0; // job file position of the next word [bytes]
+
+// Job checkpoint candidate: reached once plan_blocks_done() passes cp_blocks
+static tCheckpoint cp_next;
+static uint32_t cp_blocks;
+static int cp_valid = 0;
 
 // Bitmap buffer
 #define BITMAP_PIXELS  (8192)
@@ -93,6 +100,286 @@ unsigned long bitmap_width=0; // nr of pixels
 unsigned long bitmap_size=0; // nr of bytes
 unsigned char bitmap_bpp=1, bitmap_enable=0;
 
+static int bitmap_reverse = 0; // current bitmap line runs in negative X direction
+
+// Blank runs shorter than this (besides the overscan margins) are not worth a rapid move
+#define BITMAP_MIN_GAP 16 // [pixels]
+
+// The last move or line is held back until the next command is known: if a bitmap line
+// follows a travel move, it is replaced by a move to the start of the lead-in of that line.
+// Following segments with the same settings are merged into it while the path stays within
+// cfg->merge of the original vertices (MERGE_POINTS vertices at most).
+#define MERGE_POINTS 32
+static tActionRequest pending;
+static int move_pending = 0;
+static float merge_x0, merge_y0; // start of the pending segment [mm]
+static float merge_x[MERGE_POINTS], merge_y[MERGE_POINTS]; // merged vertices [mm]
+static int merge_n = 0;
+
+// Corners between segments with the same settings are rounded with an arc that stays
+// within blend_tol of the corner (set per job, cfg->blend by default)
+#define BLEND_MIN_ANGLE 0.02 // [rad] smaller direction changes are not rounded
+#define BLEND_MAX_ANGLE 2.6 // [rad] sharper corners (short radius, long arc) are not rounded
+static int blend_tol = 0; // [micron], 0 = off
+
+static void flush_move()
+{
+  if ( move_pending )
+  {
+    plan_buffer_line(&pending);
+    move_pending = 0;
+  }
+}
+
+/**
+*** Return the distance from (x,y) to the segment (x0,y0)-(x1,y1) [mm]
+**/
+static float segment_distance(float x, float y, float x0, float y0, float x1, float y1)
+{
+  float dx = x1 - x0, dy = y1 - y0;
+  float len2 = dx * dx + dy * dy;
+  float t = ( len2 > 0 ? ((x - x0) * dx + (y - y0) * dy) / len2 : 0 );
+  if ( t < 0 ) t = 0;
+  if ( t > 1 ) t = 1;
+  dx = x0 + t * dx - x;
+  dy = y0 + t * dy - y;
+  return sqrt(dx * dx + dy * dy);
+}
+
+/**
+*** Return true if the segment to a->target can be merged into the pending segment:
+*** same action and settings, and all merged vertices stay within cfg->merge of the new path
+**/
+static int same_settings(tActionRequest *a)
+{
+  return a->ActionType == pending.ActionType && a->param == pending.param &&
+    a->target.feed_rate == pending.target.feed_rate && a->target.z == pending.target.z &&
+    a->ppi == pending.ppi && a->pulse == pending.pulse;
+}
+
+static int can_merge(tActionRequest *a)
+{
+  float tol = cfg->merge / 1000.0; // [mm]
+  int n;
+
+  if ( !move_pending || merge_n >= MERGE_POINTS || tol <= 0 || !same_settings(a) )
+    return 0;
+  if ( segment_distance(pending.target.x, pending.target.y, merge_x0, merge_y0, a->target.x, a->target.y) > tol )
+    return 0;
+  for (n = 0; n < merge_n; n++)
+    if ( segment_distance(merge_x[n], merge_y[n], merge_x0, merge_y0, a->target.x, a->target.y) > tol )
+      return 0;
+  return 1;
+}
+
+/**
+*** Round the corner at the end of the pending segment towards a->target: the pending segment is
+*** shortened, and an arc tangent to both segments is queued. The arc stays within blend_tol of
+*** the corner, and uses at most half of both segments (their other ends may be rounded too).
+*** The pending segment is flushed; the next segment starts at the end of the arc.
+**/
+static void blend_corner(tActionRequest *a)
+{
+  float vx = pending.target.x, vy = pending.target.y;
+  float l1 = sqrt( square(vx - merge_x0) + square(vy - merge_y0) );
+  float l2 = sqrt( square(a->target.x - vx) + square(a->target.y - vy) );
+  float ux1, uy1, ux2, uy2, angle, t, r, l, cx, cy, rx, ry, tol;
+  int n, i;
+  tActionRequest seg;
+
+  if ( l1 == 0 || l2 == 0 )
+    return;
+  ux1 = (vx - merge_x0) / l1;
+  uy1 = (vy - merge_y0) / l1;
+  ux2 = (a->target.x - vx) / l2;
+  uy2 = (a->target.y - vy) / l2;
+  angle = atan2(ux1 * uy2 - uy1 * ux2, ux1 * ux2 + uy1 * uy2); // direction change, > 0: left turn
+  if ( fabs(angle) < BLEND_MIN_ANGLE || fabs(angle) > BLEND_MAX_ANGLE )
+    return;
+  t = tan(fabs(angle) / 2);
+  r = (blend_tol / 1000.0) / (1 / cos(fabs(angle) / 2) - 1); // radius for the max deviation
+  l = min(r * t, min(l1, l2) / 2); // distance from the corner to the tangent points
+  r = l / t;
+
+  pending.target.x = vx - ux1 * l;
+  pending.target.y = vy - uy1 * l;
+  flush_move();
+
+  // center: perpendicular to the first segment, at the inside of the corner
+  cx = pending.target.x + (angle > 0 ? -uy1 : uy1) * r;
+  cy = pending.target.y + (angle > 0 ? ux1 : -ux1) * r;
+  tol = cfg->curve / 1000.0;
+  n = ( r > tol && tol > 0 ? ceil(fabs(angle) / (2 * acos(1 - tol / r))) : 1 );
+  for (i = 1; i <= n; i++)
+  {
+    seg = *a; // plan_buffer_line() changes the action type
+    if ( i == n ) // end exactly on the tangent point
+    {
+      seg.target.x = vx + ux2 * l;
+      seg.target.y = vy + uy2 * l;
+    }
+    else
+    {
+      rx = pending.target.x - cx;
+      ry = pending.target.y - cy;
+      t = angle * i / n;
+      seg.target.x = cx + rx * cos(t) - ry * sin(t);
+      seg.target.y = cy + rx * sin(t) + ry * cos(t);
+    }
+    plan_buffer_line(&seg);
+  }
+}
+
+/**
+*** Queue a move or line. It is held back, so the next segment can be merged into it
+*** (or the corner towards the next segment can be rounded).
+*** blend: round the corner towards a; not between the lines of a curve, they are already
+*** within cfg->curve of the curve
+**/
+static void queue_line(tActionRequest *a, int blend)
+{
+  if ( can_merge(a) )
+  {
+    merge_x[merge_n] = pending.target.x;
+    merge_y[merge_n] = pending.target.y;
+    merge_n++;
+  }
+  else
+  {
+    if ( blend && move_pending && blend_tol > 0 && same_settings(a) )
+      blend_corner(a);
+    flush_move();
+    merge_x0 = startpoint.x;
+    merge_y0 = startpoint.y;
+    merge_n = 0;
+  }
+  pending = *a;
+  move_pending = 1;
+}
+
+/**
+*** Arcs and cubic bezier curves are split in lines with a chord error below cfg->curve.
+*** The lines are generated lazily: only while the planner queue has room (from ready() and
+*** queue()), so a long curve never holds more than a few lines ahead of the queue.
+**/
+#define CURVE_ARC 1
+#define CURVE_BEZIER 2
+static int curve_type = 0, curve_n = 0, curve_i = 0; // curve type, nr of lines, next line
+static tActionRequest curve; // settings and end point for the lines of the curve
+static float curve_p[8]; // arc: center, radius vector, cos and sin of the angle step. bezier: control points
+
+/**
+*** Start an arc from the current position to curve.target around (cx,cy) [mm]
+*** Clockwise (dir 0) or counterclockwise (dir 1). Equal start and end points make a full circle.
+**/
+static void arc_start(float cx, float cy, int dir)
+{
+  float x0 = (move_pending ? pending.target.x : startpoint.x);
+  float y0 = (move_pending ? pending.target.y : startpoint.y);
+  float rx = x0 - cx, ry = y0 - cy;
+  float r = sqrt(rx * rx + ry * ry), tol = cfg->curve / 1000.0;
+  float angle = atan2(curve.target.y - cy, curve.target.x - cx) - atan2(ry, rx);
+  float da;
+
+  if ( dir && angle <= 0 ) angle += 2 * M_PI;
+  if ( !dir && angle >= 0 ) angle -= 2 * M_PI;
+  if ( tol <= 0 ) tol = 0.001;
+  da = ( r > tol ? 2 * acos(1 - tol / r) : M_PI / 2 ); // max angle per line
+  curve_type = CURVE_ARC;
+  curve_n = max(ceil(fabs(angle) / da), 1);
+  curve_i = 0;
+  curve_p[0] = cx;
+  curve_p[1] = cy;
+  curve_p[2] = rx;
+  curve_p[3] = ry;
+  curve_p[4] = cos(angle / curve_n);
+  curve_p[5] = sin(angle / curve_n);
+  curve_p[6] = atan2(ry, rx);
+  curve_p[7] = angle / curve_n;
+}
+
+/**
+*** Start a cubic bezier curve from the current position to curve.target with control points
+*** (x1,y1) and (x2,y2) [mm]. The chord error of n equal parameter steps is below 3/4 L / n^2,
+*** with L the largest second difference of the control points.
+**/
+static void bezier_start(float x1, float y1, float x2, float y2)
+{
+  float x0 = (move_pending ? pending.target.x : startpoint.x);
+  float y0 = (move_pending ? pending.target.y : startpoint.y);
+  float x3 = curve.target.x, y3 = curve.target.y;
+  float tol = cfg->curve / 1000.0;
+  float l1 = sqrt( square(x0 - 2 * x1 + x2) + square(y0 - 2 * y1 + y2) );
+  float l2 = sqrt( square(x1 - 2 * x2 + x3) + square(y1 - 2 * y2 + y3) );
+
+  if ( tol <= 0 ) tol = 0.001;
+  curve_type = CURVE_BEZIER;
+  curve_n = max(ceil(sqrt(0.75 * max(l1, l2) / tol)), 1);
+  curve_i = 0;
+  curve_p[0] = x0;
+  curve_p[1] = y0;
+  curve_p[2] = x1;
+  curve_p[3] = y1;
+  curve_p[4] = x2;
+  curve_p[5] = y2;
+}
+
+/**
+*** Queue the next line of the current curve. Returns the nr of lines that are left.
+**/
+static int curve_next()
+{
+  tActionRequest seg;
+  float t, u, rx, ry;
+
+  if ( curve_i >= curve_n )
+    return 0;
+  seg = curve;
+  curve_i++;
+  if ( curve_i < curve_n ) // the last line ends exactly on the end point
+  {
+    if ( curve_type == CURVE_ARC )
+    {
+      if ( curve_i % N_ARC_CORRECTION ) // rotate the radius vector by the angle step
+      {
+        rx = curve_p[2] * curve_p[4] - curve_p[3] * curve_p[5];
+        ry = curve_p[2] * curve_p[5] + curve_p[3] * curve_p[4];
+      }
+      else // correct the accumulated round-off now and then
+      {
+        t = sqrt( square(curve_p[2]) + square(curve_p[3]) );
+        u = curve_p[6] + curve_i * curve_p[7];
+        rx = t * cos(u);
+        ry = t * sin(u);
+      }
+      curve_p[2] = rx;
+      curve_p[3] = ry;
+      seg.target.x = curve_p[0] + rx;
+      seg.target.y = curve_p[1] + ry;
+    }
+    else
+    {
+      t = (float)curve_i / curve_n;
+      u = 1 - t;
+      seg.target.x = u*u*u * curve_p[0] + 3*u*u*t * curve_p[2] + 3*u*t*t * curve_p[4] + t*t*t * curve.target.x;
+      seg.target.y = u*u*u * curve_p[1] + 3*u*u*t * curve_p[3] + 3*u*t*t * curve_p[5] + t*t*t * curve.target.y;
+    }
+  }
+  queue_line(&seg, curve_i == 1); // only the corner towards the start of the curve
+  return curve_n - curve_i;
+}
+
+/**
+*** Queue lines of the current curve while the planner queue has room.
+*** Returns the nr of lines that are left.
+**/
+static int curve_fill()
+{
+  while ( curve_i < curve_n && !plan_queue_full() )
+    curve_next();
+  return curve_n - curve_i;
+}
+
 /**
 *** LaosMotion() Constructor
 *** Make new motion object
@@ -107,7 +394,7 @@ LaosMotion::LaosMotion()
   pwm.period(1.0 / cfg->pwmfreq);
   pwm = cfg->pwmmin/100.0;
   if ( laser == NULL ) laser = new DigitalOut(LASER_PIN);
-  laser_on(LASEROFF);
+  laser_init();
 
   mark_speed = cfg->speed;
   //start.mode(PullUp);
@@ -165,6 +452,13 @@ LaosMotion::~LaosMotion()
 **/
 void LaosMotion::reset()
 {
+  move_pending = 0;
+  words = cp_valid = 0;
+  job_offset = 0;
+  blend_tol = cfg->blend;
+  curve_n = curve_i = 0;
+  action.ppi = 0;
+  action.pulse = cfg->pulse;
   step = command = xstep = xdir = ystep = ydir = zstep = zdir = 0;
 //  ofsx = ofsy = ofsz = 0;
   enable = cfg->enable;
@@ -180,7 +474,12 @@ void LaosMotion::reset()
 **/
 int LaosMotion::ready()
 {
-  return !plan_queue_full();
+  static int was_ready = 1;
+  int r = !curve_fill() && !plan_queue_full();
+  if ( was_ready && !r )
+    motion_stats.queue_full++;
+  was_ready = r;
+  return r;
 }
 
 
@@ -190,27 +489,145 @@ int LaosMotion::ready()
 **/
 int LaosMotion::queue()
 {
-  return plan_queue_items();
+  int left = curve_fill();
+  if ( !left )
+    flush_move();
+  return plan_queue_items() + left;
 }
 
 
 void LaosMotion::clearBuffer()
 {
+  move_pending = 0;
+  curve_n = curve_i = 0;
   plan_clear_buffer();
   clear_current_block();
 }
 
 
+/**
+*** setJobOffset()
+*** Job file position of the next word written, a checkpoint at that word can seek to it
+**/
+void LaosMotion::setJobOffset(long ofs)
+{
+  job_offset = ofs;
+}
+
+/**
+*** checkpoint()
+*** Returns 1 and fills cp when a new checkpoint is reached (all motion before it is executed)
+**/
+int LaosMotion::checkpoint(tCheckpoint *cp)
+{
+  if ( !cp_valid || (int32_t)(plan_blocks_done() - cp_blocks) < 0 )
+    return 0;
+  *cp = cp_next;
+  cp_valid = 0;
+  return 1;
+}
+
+/**
+*** restore()
+*** Restore the parser state of a checkpoint. The job file must be positioned at cp->offset.
+**/
+void LaosMotion::restore(tCheckpoint *cp)
+{
+  step = 0;
+  words = cp->words;
+  power = cp->power;
+  mark_speed = cp->speed;
+  action.ppi = cp->ppi;
+  action.pulse = cp->pulse;
+  blend_tol = cp->blend;
+  ofsx = cp->ofsx;
+  ofsy = cp->ofsy;
+  ofsz = cp->ofsz;
+  bitmap_enable = 0;
+  cp_valid = 0;
+}
+
+/**
+*** getStats()
+*** Copy the motion counters
+**/
+void LaosMotion::getStats(tMotionStats *st)
+{
+  __disable_irq();
+  memcpy(st, (void*)&motion_stats, sizeof(tMotionStats));
+  __enable_irq();
+}
+
+/**
+*** resetStats()
+*** Reset the motion counters (at the start of a job)
+**/
+void LaosMotion::resetStats()
+{
+  __disable_irq();
+  st_reset_stats();
+  prof_reset();
+  __enable_irq();
+}
+
+/**
+*** printStats()
+*** Write the motion counters as text (serial port or file)
+**/
+void LaosMotion::printStats(FILE *fp)
+{
+  tMotionStats st;
+  getStats(&st);
+  fprintf(fp, "blocks: %lu\r\n", (unsigned long)st.blocks);
+  fprintf(fp, "underruns: %lu\r\n", (unsigned long)st.underruns);
+  fprintf(fp, "queue full: %lu\r\n", (unsigned long)st.queue_full);
+  fprintf(fp, "isr reentries: %lu\r\n", (unsigned long)st.reentries);
+  fprintf(fp, "isr max: %lu usec\r\n", (unsigned long)(st.isr_max / (SystemCoreClock / 1000000)));
+  fprintf(fp, "step rate max: %lu steps/sec\r\n", (unsigned long)st.rate_max);
+  fprintf(fp, "laser on: %.1f sec\r\n", st.laser_ms / 1000.0);
+  fprintf(fp, "estimate: %.1f sec\r\n", st.est_time);
+}
+
+/**
+*** hold()
+*** Feed hold: decelerate to a stop along the planned path. The queue is kept, resume() continues.
+**/
+void LaosMotion::hold()
+{
+  st_feed_hold();
+}
+
+/**
+*** resume()
+*** Continue after a feed hold (waits until the deceleration is finished)
+**/
+void LaosMotion::resume()
+{
+  while ( !isHeld() ) sched_run(); // wait for the deceleration to finish
+  st_feed_resume();
+}
+
+/**
+*** isHeld()
+*** True when the motion is stopped by a feed hold
+**/
+bool LaosMotion::isHeld()
+{
+  return st_is_held();
+}
+
 /**
 *** MoveTo()
 **/
 void LaosMotion::moveTo(int x, int y, int z)
 {
+   while ( curve_next() );
+   flush_move();
    action.target.x = ofsx/1000.0 + x/1000.0;
    action.target.y = ofsy/1000.0 + y/1000.0;
    action.target.z = ofsz/1000.0 + z/1000.0;
    action.ActionType = AT_MOVE;
-   action.target.feed_rate =  60.0 * cfg->speed;
+   action.target.feed_rate =  60.0 * cfg->rapidspeed;
    plan_buffer_line(&action);
   // printf("To buffer: %d, %d\r\n", x, y);
 }
@@ -220,6 +637,8 @@ void LaosMotion::moveTo(int x, int y, int z)
 **/
 void LaosMotion::moveTo(int x, int y, int z, int speed)
 {
+   while ( curve_next() );
+   flush_move();
    action.target.x = ofsx/1000.0 + x/1000.0;
    action.target.y = ofsy/1000.0 + y/1000.0;
    action.target.z = ofsz/1000.0 + z/1000.0;
@@ -229,18 +648,185 @@ void LaosMotion::moveTo(int x, int y, int z, int speed)
    //printf("To buffer: %d, %d\r\n", x, y);
 }
 
+/**
+*** Return true if pixel i of the current bitmap line is marked (laser on).
+*** Lines in negative X direction read the bitmap from the end (like the step interrupt does)
+**/
+static inline int bitmap_pixel(int i)
+{
+  if ( bitmap_reverse )
+    i = bitmap_width - 1 - i;
+  return bitmap[i / 32] & (1 << (i % 32));
+}
+
+/**
+*** Return the first marked pixel at or after i, or bitmap_width if there is none
+*** Blank dwords are skipped as a whole
+**/
+static int bitmap_next_pixel(int i)
+{
+  int b;
+  while ( i < (int)bitmap_width )
+  {
+    b = ( bitmap_reverse ? bitmap_width - 1 - i : i );
+    if ( (b % 32) == (bitmap_reverse ? 31 : 0) && bitmap[b / 32] == 0 )
+      i += 32;
+    else if ( bitmap_pixel(i) )
+      return i;
+    else
+      i++;
+  }
+  return bitmap_width;
+}
+
+/**
+*** Queue a laser-off move of a bitmap line to (x,y) at the given feed rate [mm/min]
+**/
+static void bitmap_move(tActionRequest *line, float x, float y, float feed_rate)
+{
+  tActionRequest mv = *line;
+  mv.ActionType = AT_MOVE;
+  mv.target.x = x;
+  mv.target.y = y;
+  mv.target.feed_rate = feed_rate;
+  plan_buffer_line(&mv);
+}
+
+/**
+*** Queue one segment of a bitmap line: pixels [from..to) at mark speed
+**/
+static void bitmap_segment(tActionRequest *line, float x0, float y0, int from, int to)
+{
+  tActionRequest seg = *line;
+  seg.target.x = x0 + ((line->target.x - x0) * to) / bitmap_width;
+  seg.target.y = y0 + ((line->target.y - y0) * to) / bitmap_width;
+  seg.bitmap_ofs = from;
+  seg.bitmap_len = to - from;
+  plan_buffer_line(&seg);
+}
+
+/**
+*** Return the overscan distance [mm] from (x,y) in direction (ux,uy), limited to d
+*** and clipped so we stay inside the machine limits
+**/
+static float bitmap_overscan(float x, float y, float ux, float uy, float d)
+{
+  if ( ux > 0 ) d = min(d, (cfg->xmax/1000.0 - x) / ux);
+  if ( ux < 0 ) d = min(d, (cfg->xmin/1000.0 - x) / ux);
+  if ( uy > 0 ) d = min(d, (cfg->ymax/1000.0 - y) / uy);
+  if ( uy < 0 ) d = min(d, (cfg->ymin/1000.0 - y) / uy);
+  return max(d, 0);
+}
+
+/**
+*** Queue a bitmap line from the current position to line->target.
+*** Only the marked pixel span is burned: leading and trailing blank pixels are trimmed, and
+*** long blank runs inside the line are crossed with laser-off rapid moves (every marked run
+*** keeps a margin of blank pixels at mark speed on both sides). The lead-in and lead-out
+*** moves are added here: just long enough to reach mark speed from rest (the queue is
+*** empty when a bitmap is loaded) and to stop again, so the host does not have to pad lines.
+*** A held-back travel move to the start of the line is replaced by a move to the lead-in.
+*** Lines can be burned in both directions (the bitmap is always stored in positive X order),
+*** the complete line is shifted by the configured laser delay for its direction.
+**/
+static void bitmap_line(tActionRequest *in)
+{
+  tActionRequest ln = *in, *line = &ln;
+  float x0, y0, ux, uy, xs, ys, xe, ye;
+  float len, v, d, shift, leadin, leadout;
+  int first, last, start, end, next, margin;
+
+  if ( move_pending && pending.ActionType != AT_MOVE ) // only a travel move can be replaced
+    flush_move();
+  x0 = (move_pending ? pending.target.x : startpoint.x);
+  y0 = (move_pending ? pending.target.y : startpoint.y);
+  len = sqrt( (line->target.x - x0) * (line->target.x - x0) + (line->target.y - y0) * (line->target.y - y0) );
+  bitmap_reverse = (line->target.x < x0);
+  first = bitmap_next_pixel(0);
+  if ( first >= (int)bitmap_width || len == 0 ) // nothing to mark on this line
+    return;
+  for (last = bitmap_width-1; !bitmap_pixel(last); last--);
+
+  ux = (line->target.x - x0) / len;
+  uy = (line->target.y - y0) / len;
+  v = line->target.feed_rate / 60.0; // [mm/sec]
+  d = plan_ramp_distance(AT_MOVE, ux, uy, v); // distance to reach mark speed on the lead-in (a travel move) [mm]
+
+  // switch the laser earlier (positive shift) to compensate laser latency and backlash
+  shift = v * (bitmap_reverse ? cfg->shiftneg : cfg->shiftpos) / 1E6; // [mm]
+  x0 -= ux * shift;
+  y0 -= uy * shift;
+  line->target.x -= ux * shift;
+  line->target.y -= uy * shift;
+  margin = ceil(d * bitmap_width / len);
+
+  // lead-in: travel to the start of the acceleration ramp, then accelerate up to the first pixel
+  xs = x0 + ((line->target.x - x0) * first) / bitmap_width;
+  ys = y0 + ((line->target.y - y0) * first) / bitmap_width;
+  leadin = bitmap_overscan(xs, ys, -ux, -uy, d);
+  bitmap_move(line, xs - ux * leadin, ys - uy * leadin, move_pending ? pending.target.feed_rate : 60.0 * cfg->rapidspeed);
+  move_pending = 0;
+  bitmap_move(line, xs, ys, line->target.feed_rate);
+
+  start = first;
+  end = first;
+  while ( end < last )
+  {
+    next = bitmap_next_pixel(end + 1);
+    if ( next - end - 1 > 2 * margin + BITMAP_MIN_GAP )
+    {
+      bitmap_segment(line, x0, y0, start, end + margin + 1);
+      start = next - margin;
+      bitmap_move(line, x0 + ((line->target.x - x0) * start) / bitmap_width,
+        y0 + ((line->target.y - y0) * start) / bitmap_width, 60.0 * cfg->rapidspeed);
+    }
+    end = next;
+  }
+  bitmap_segment(line, x0, y0, start, last + 1);
+
+  // lead-out: decelerate after the last pixel
+  xe = x0 + ((line->target.x - x0) * (last + 1)) / bitmap_width;
+  ye = y0 + ((line->target.y - y0) * (last + 1)) / bitmap_width;
+  leadout = bitmap_overscan(xe, ye, ux, uy, d);
+  if ( leadout > 0 )
+    bitmap_move(line, xe + ux * leadout, ye + uy * leadout, line->target.feed_rate);
+}
+
 /**
 *** write()
 *** Write command and parameters to motion controller
 **/
 int LaosMotion::write(int i,int mode)
 {
-  static int x=0,y=0,z=0,power=10000;
+  words++;
+  static int x=0,y=0,z=0;
+  static int args[6];
   //if (  plan_queue_empty() )
   //printf("Empty\r\n");
   if ( step == 0 )
   {
     command = i;
+    while ( curve_next() ); // finish the previous curve
+    if ( command == 0 && mode == MODE_RUN && !bitmap_enable && !cp_valid )
+    {
+      // checkpoint candidate: resume here once everything queued before this move is executed
+      cp_next.words = words - 1; // words before this command
+      cp_next.offset = job_offset;
+      cp_next.power = power;
+      cp_next.speed = mark_speed;
+      cp_next.ppi = action.ppi;
+      cp_next.pulse = action.pulse;
+      cp_next.blend = blend_tol;
+      cp_next.ofsx = ofsx;
+      cp_next.ofsy = ofsy;
+      cp_next.ofsz = ofsz;
+      cp_blocks = plan_blocks_queued() + move_pending;
+      cp_valid = 1;
+    }
+    if ( command == 9 && move_pending && pending.ActionType != AT_MOVE )
+      flush_move();
+    else if ( command != 7 && command != 9 && command != 0 && command != 1 && command != 3 && command != 6 )
+      flush_move();
     step++;
   }
   else
@@ -253,9 +839,7 @@ int LaosMotion::write(int i,int mode)
             {
               case 1:
                 action.target.x = ofsx/1000.0+i/1000.0;
-                printf("ofsx: %d\r\n",ofsx);
-                printf("i: %d\r\n",i);
-                printf("action.target.x: %d\r\n",action.target.x);
+                TRACE(TRACE_DEBUG, EV_TARGET, ofsx, i, ofsx+i);
                 break;
               case 2:
                 action.target.y = ofsy/1000.0+i/1000.0;;
@@ -279,8 +863,13 @@ int LaosMotion::write(int i,int mode)
                 if(mode==MODE_SIMULATE && (action.target.x>cfg->xmax/1000.0 || action.target.y>cfg->ymax/1000.0 || action.target.x < cfg->xmin/1000.0 || action.target.y < cfg->ymin/1000.0)){
                   return 1;
                 }
-                action.target.feed_rate =  60.0 * (command ? mark_speed : cfg->speed );
-                if(mode!=MODE_SIMULATE) plan_buffer_line(&action);
+                action.target.feed_rate =  60.0 * (command ? mark_speed : cfg->rapidspeed );
+                if ( mode == MODE_SIMULATE )
+                  break;
+                if ( action.ActionType == AT_BITMAP || action.ActionType == AT_BITMAP_TESTRUN )
+                  bitmap_line(&action);
+                else
+                  queue_line(&action, 1);
                 break;
             }
             break;
@@ -297,6 +886,36 @@ int LaosMotion::write(int i,int mode)
                 break;
             }
             break;
+         case 3: // arc x,y around cx,cy (laser on). format: 3 <x> <y> <cx> <cy> <dir>, dir: 0 = CW, 1 = CCW
+         case 6: // cubic bezier curve (laser on). format: 6 <x1> <y1> <x2> <y2> <x> <y>
+            if ( step <= 6 )
+              args[step-1] = i;
+            if ( step == (command == 3 ? 5 : 6) )
+            {
+              step = 0;
+              curve = action;
+              curve.target.x = ofsx/1000.0 + args[command == 3 ? 0 : 4]/1000.0;
+              curve.target.y = ofsy/1000.0 + args[command == 3 ? 1 : 5]/1000.0;
+              curve.target.z = ofsz;
+              curve.param = power;
+              curve.ActionType = ( mode == MODE_TEST ? AT_MOVE : AT_LASER );
+              curve.target.feed_rate = 60.0 * mark_speed;
+              if ( mode == MODE_SIMULATE )
+              {
+                if ( curve.target.x > cfg->xmax/1000.0 || curve.target.y > cfg->ymax/1000.0 ||
+                  curve.target.x < cfg->xmin/1000.0 || curve.target.y < cfg->ymin/1000.0 )
+                  return 1;
+                break;
+              }
+              action.target = curve.target;
+              if ( command == 3 )
+                arc_start(ofsx/1000.0 + args[2]/1000.0, ofsy/1000.0 + args[3]/1000.0, args[4]);
+              else
+                bezier_start(ofsx/1000.0 + args[0]/1000.0, ofsy/1000.0 + args[1]/1000.0,
+                  ofsx/1000.0 + args[2]/1000.0, ofsy/1000.0 + args[3]/1000.0);
+              curve_fill();
+            }
+            break;
          case 4: // set x,y,z (absolute)
             switch ( step )
             {
@@ -334,7 +953,20 @@ int LaosMotion::write(int i,int mode)
                     break;
                   case 101:
                     power = val;
-                    printf("power: %d\r\n", power);
+                    TRACE(TRACE_INFO, EV_POWER, power, 0, 0);
+                    break;
+                  case 102: // ppi mode: pulse pitch [micron], 0 = continuous
+                    if ( val < 0 ) val = 0;
+                    if ( val > 65535 ) val = 65535;
+                    action.ppi = val;
+                    break;
+                  case 103: // ppi mode: pulse length [usec]
+                    if ( val < 1 ) val = 1;
+                    if ( val > 65535 ) val = 65535;
+                    action.pulse = val;
+                    break;
+                  case 104: // corner rounding: max deviation [micron], 0 = off
+                    blend_tol = max(val, 0);
                     break;
                 }
                 break;
@@ -348,7 +980,7 @@ int LaosMotion::write(int i,int mode)
             else if ( step == 2 )
             {
            //   if ( queue() ) printf("Queue not empty... wait...\r\n");
-              while ( queue() );// printf("+"); // wait for queue to empty
+              while ( plan_queue_items() ) sched_run(); // wait for queue to empty
               bitmap_width = i;
               bitmap_enable = 1;
               bitmap_size = (bitmap_bpp * bitmap_width) / 32;
@@ -361,7 +993,7 @@ int LaosMotion::write(int i,int mode)
             {
               bitmap[ (step-3) % BITMAP_SIZE ] = i;
 			  // printf("[%ld] = %ld\r\n", (step-3) % BITMAP_SIZE, i);
-			  if ( step-2 == bitmap_size ) // last dword received
+			  if ( (unsigned long)(step-2) == bitmap_size ) // last dword received
               {
                 step = 0;
                 // printf("Bitmap: received %d dwords\r\n", bitmap_size);
@@ -404,7 +1036,9 @@ bool LaosMotion::endstopReached(){
 }
 
 bool LaosMotion::clearEndstop(){
+  bool was = endstopreached;
   endstopreached=false;
+  return was;
 }
 
 /**
@@ -455,43 +1089,51 @@ void LaosMotion::overrideSafety(bool enable)
   overrider=!enable;
 }
 
-void timerMoveY()
-{
-  if(!interrupt_busy){
-    interrupt_busy=1;
-    ystep = !ystep;
-    if(endstopReachedTest()) endstopreached=true;
-    if(ystep){
-      steps++;
-    }
-    counter++;
-    interrupt_busy=0;
-  }
-}
-
-void timerMoveX()
+/**
+*** Queue the next jog segment in direction (ux,uy) [mm], (x,y) is the end of the last segment.
+*** After homing, the segments stop at the machine limits. Returns 0 if there is no room left.
+**/
+static int jog_segment(float *x, float *y, float ux, float uy, float len, int homed)
 {
-  if(!interrupt_busy){
-    interrupt_busy=1;
-    xstep = !xstep;
-    if(endstopReachedTest()) endstopreached=true;
-    if(xstep){
-      steps++;
-    }
-    counter++;
-    interrupt_busy=0;
+  tActionRequest a;
+  float lim;
+  if ( homed )
+  {
+    lim = (ux > 0 ? cfg->xmax/1000.0 - *x : ux < 0 ? *x - cfg->xmin/1000.0 : len);
+    if ( uy > 0 && cfg->ymax/1000.0 - *y < lim ) lim = cfg->ymax/1000.0 - *y;
+    if ( uy < 0 && *y - cfg->ymin/1000.0 < lim ) lim = *y - cfg->ymin/1000.0;
+    if ( lim < 0.001 )
+      return 0;
+    if ( len > lim )
+      len = lim;
   }
+  *x += ux * len;
+  *y += uy * len;
+  a.ActionType = AT_MOVE;
+  a.target = startpoint;
+  a.target.x = *x;
+  a.target.y = *y;
+  a.target.feed_rate = 60.0 * cfg->rapidspeed;
+  a.param = a.bitmap_ofs = a.bitmap_len = a.ppi = 0;
+  a.pulse = cfg->pulse;
+  plan_buffer_line(&a);
+  return 1;
 }
 
+/**
+*** Jog with the arrow keys: while a key is held, JOG_BLOCKS short segments are kept in the
+*** planner queue (together long enough to stop from full speed). On release, a feed hold
+*** decelerates to a stop and the rest of the queue is dropped.
+**/
+#define JOG_BLOCKS 4
 void LaosMotion::manualMove()
 {
-  LaosDisplay *dsp;
-  int c;
-  endstopreached=false;
-  int countupto = 50;
-  int speed;
+  int c, key, i;
   int x,y,z;
   int args[5];
+  float ux, uy, jx, jy, len, xx, yy, zz;
+  endstopreached=false;
+  while ( queue() ) sched_run(); // finish any motion first
   getPosition(&x,&y,&z);
   args[0]=x/1000.0;
   args[1]=y/1000.0;
@@ -499,196 +1141,139 @@ void LaosMotion::manualMove()
   while(1){
     if(cover==0 || endstopReached()) return;
     c=dsp->read();
-    counter=0;
     switch(c){
       case K_CANCEL:
         return;
       case K_UP:
       case K_DOWN:
-        speed=cfg->manualspeed*4;
-        if(cfg->yscale>0){
-          (c==K_UP) ? ydir = 1 : ydir = 0;
-        }else{
-          (c==K_UP) ? ydir = 0 : ydir = 1;
-        }
-        timer.attach_us(&timerMoveY,speed);
-        while(1){
-          if(endstopreached){
-            timer.detach();
-            return;
-          }
-          c = dsp->read();
-          if((c!=K_UP && c!=K_DOWN) || cover==0){
-            counter=0;
-            while(speed<cfg->manualspeed*2){
-              wait_ms(1); // this "fixes" a (timing?) bug.... doesn't work without this...
-              if(counter>=countupto){
-                speed=speed*1.05;
-                counter=0;
-                timer.attach_us(&timerMoveY,speed);
-              }
-            }
-            timer.detach();
-            ystep=0;
-            if(ydir){
-              y=y+(steps/(cfg->yscale/1000000.0));
-            }else{
-              y=y-(steps/(cfg->yscale/1000000.0));
-            }
-            args[0]=x/1000.0;
-            args[1]=y/1000.0;
-            dsp->ShowScreen("X: +6543210 mm  " "Y: +6543210 mm  ", args, NULL);
-            steps=0;
-            setPosition(x,y,z);
-            break;
-          }
-          if(counter>=countupto){
-            if(cfg->manualspeed<speed){
-              speed=speed/1.1;
-              if(speed<cfg->manualspeed) speed=cfg->manualspeed;
-              timer.attach_us(&timerMoveY,speed);
-            }
-            args[0]=x/1000.0;
-            if(ydir){
-              args[1]=y/1000.0+(steps/(cfg->yscale/1000));
-            }else{
-              args[1]=y/1000.0-(steps/(cfg->yscale/1000));
-            }
-            dsp->ShowScreen("X: +6543210 mm  " "Y: +6543210 mm  ", args, NULL);
-            counter=0;
-          }
-        }
-        break;
       case K_LEFT:
       case K_RIGHT:
-        speed=cfg->manualspeed*4;
-        if(cfg->xscale>0){
-          (c==K_RIGHT) ? xdir = 1 : xdir = 0;
-        }else{
-          (c==K_RIGHT) ? xdir = 0 : xdir = 1;
-        }
-        timer.attach_us(&timerMoveX,speed);
-        while(1){
-          if(endstopreached){
-            timer.detach();
-            return;
-          }
-          c = dsp->read();
-          if((c!=K_LEFT && c!=K_RIGHT) || cover==0){
-            counter=0;
-            while(speed<cfg->manualspeed*2){
-              wait_ms(1); // this "fixes" a (timing?) bug.... doesn't work without this...
-              if(counter>=countupto){
-                speed=speed*1.05;
-                counter=0;
-                timer.attach_us(&timerMoveX,speed);
-              }
-            }
-            timer.detach();
-            xstep=0;
-            if(xdir){
-              x=x+(steps/(cfg->xscale/1000000.0));
-            }else{
-              x=x-(steps/(cfg->xscale/1000000.0));
-            }
-            args[0]=x/1000.0;
-            args[1]=y/1000.0;
-            dsp->ShowScreen("X: +6543210 mm  " "Y: +6543210 mm  ", args, NULL);
-            steps=0;
-            setPosition(x,y,z);
+        key = c;
+        ux = (c==K_RIGHT) ? 1 : (c==K_LEFT) ? -1 : 0;
+        uy = (c==K_UP) ? 1 : (c==K_DOWN) ? -1 : 0;
+        len = plan_ramp_distance(AT_MOVE, ux, uy, cfg->rapidspeed) / (JOG_BLOCKS-1); // [mm]
+        if ( len < 1 ) len = 1;
+        plan_get_current_position_xyz(&jx, &jy, &zz);
+        i = 0;
+        while ( c == key && cover != 0 )
+        {
+          if ( plan_queue_items() < JOG_BLOCKS && !jog_segment(&jx, &jy, ux, uy, len, isHome) && plan_queue_empty() )
+            break;
+          if ( endstopReachedTest() )
+          {
+            endstopreached = true;
             break;
           }
-          if(counter>=countupto){
-            if(cfg->manualspeed<speed){
-              speed=speed/1.1;
-              if(speed<cfg->manualspeed) speed=cfg->manualspeed;
-              timer.attach_us(&timerMoveX,speed);
-            }
+          if ( (++i % 20) == 0 )
+          {
+            getPosition(&x,&y,&z);
+            args[0]=x/1000.0;
             args[1]=y/1000.0;
-            if(ydir){
-              args[0]=x/1000.0+(steps/(cfg->xscale/1000));
-            }else{
-              args[0]=x/1000.0-(steps/(cfg->xscale/1000));
-            }
             dsp->ShowScreen("X: +6543210 mm  " "Y: +6543210 mm  ", args, NULL);
-            counter=0;
           }
+          sched_run();
+          c = dsp->read();
         }
+        // stop: decelerate, drop the remaining segments and continue from the actual position
+        hold();
+        while ( !isHeld() ) sched_run();
+        clearBuffer();
+        plan_get_current_position_xyz(&xx, &yy, &zz);
+        plan_set_current_position_xyz(xx, yy, zz);
+        getPosition(&x,&y,&z);
+        args[0]=x/1000.0;
+        args[1]=y/1000.0;
+        dsp->ShowScreen("X: +6543210 mm  " "Y: +6543210 mm  ", args, NULL);
         break;
     }
   }
 }
 
+#define HOME_XY ((1<<X_STEP_BIT) | (1<<Y_STEP_BIT))
+#define HOME_Z (1<<Z_STEP_BIT)
+
+/**
+*** Relative homing move [mm] at speed [mm/sec]. The axes in endstops (step bits, 0: a plain move)
+*** stop at their end-stop (AT_MOVE_ENDSTOP).
+*** The move runs from the step interrupt, the other tasks keep running while we wait.
+*** Returns 0 when canceled (cancel key or cover open) or when an end-stop was not reached.
+**/
+static int home_move(float x, float y, float z, float speed, uint32_t endstops)
+{
+  tActionRequest a;
+  uint32_t missed;
+  plan_set_current_position_xyz(0, 0, 0);
+  a.ActionType = ( endstops ? AT_MOVE_ENDSTOP : AT_MOVE );
+  a.target.x = x;
+  a.target.y = y;
+  a.target.z = z;
+  a.target.e = startpoint.e;
+  a.target.feed_rate = 60.0 * speed;
+  a.param = a.bitmap_ofs = a.bitmap_len = a.ppi = 0;
+  a.pulse = cfg->pulse;
+  st_endstops_expect(endstops);
+  plan_buffer_line(&a);
+  while ( !plan_queue_empty() )
+  {
+    sched_run();
+    if ( dsp->read() == K_CANCEL || cover == 0 )
+    {
+      plan_clear_buffer();
+      clear_current_block();
+      return 0;
+    }
+  }
+  missed = st_endstops_missed();
+  if ( missed )
+  {
+    printf("Home: end-stop not found:%s%s%s\r\n", (missed & (1<<X_STEP_BIT)) ? " X" : "",
+      (missed & (1<<Y_STEP_BIT)) ? " Y" : "", (missed & (1<<Z_STEP_BIT)) ? " Z" : "");
+    return 0;
+  }
+  return 1;
+}
+
 /**
-*** Home the axis, stop when both home switches are pressed
+*** Home the axis, stop when both home switches are pressed.
+*** The position is only set (isHome) when every axis reached its end-stop.
 **/
 void LaosMotion::home(int x, int y, int z)
 {
-  LaosDisplay *dsp;
-  int i=0;
-  int canceled = 0;
-  int c = 0;
-  int counter = 0;
+  float dx, dy, dz; // homing direction [+1/-1]
+  float slow, back;
   ofsx=ofsy=ofsz=0;
-  int countupto = (cfg->xscale/1000)*5; // check cancel button state every 5mm (maybe)
-  printf("Homing %d,%d, %d with speed %d\r\n", x, y, z, cfg->homespeed);
-  xdir = cfg->xhomedir;
-  ydir = cfg->yhomedir;
-  zdir = cfg->zhomedir;
+  TRACE(TRACE_INFO, EV_HOME, x, y, z);
   led1 = 0;
   isHome = false;
-  printf("Home Z...\r\n");
+  clearBuffer();
+
+  // the direction signal equals x.homedir when homing, a negative scale inverts the direction signal
+  dx = ((cfg->xhomedir != 0) != (cfg->xscale < 0)) ? 1 : -1;
+  dy = ((cfg->yhomedir != 0) != (cfg->yscale < 0)) ? 1 : -1;
+  dz = ((cfg->zhomedir != 0) != (cfg->zscale < 0)) ? 1 : -1;
+  back = cfg->homeback / 1000.0;
+
   if (cfg->autozhome) {
-    while ((zmin ^ cfg->zpol) && (zmax ^ cfg->zpol) && !canceled) {
-      if(counter==countupto){
-        c = dsp->read();
-        if(c==K_CANCEL || cover==0){
-          isHome = false;
-          return;
-        }
-        counter=0;
-      }else{
-        counter++;
-      }
-      zstep = 0;
-        wait(cfg->homespeed/1E6);
-        zstep = 1;
-        wait(cfg->homespeed/1E6);
-    }
-  }
-  counter=0;
-  printf("Home XY...\r\n");
-  while ( 1 && !canceled )
-  {
-    if(counter==countupto){
-      c = dsp->read();
-      if(c==K_CANCEL || cover==0){
-        isHome = false;
-        return;
-      }
-      counter=0;
-    }else{
-      counter++;
-    }
-    xstep = ystep = 0;
-    wait(cfg->homespeed/1E6);
-    xstep = xhome ^ cfg->xpol;
-    ystep = yhome ^ cfg->ypol;
-    wait(cfg->homespeed/1E6);
-
-    led2 = !xhome;
-    led3 = !yhome;
-    led4 = ((i++) & 0x10000);
-    if ( !(xhome ^ cfg->xpol) && !(yhome ^ cfg->ypol) )
-    {
-      setPosition(x,y,z);
-      moveTo(x,y,z);
-      isHome = true;
-      printf("Home done.\r\n");
+    printf("Home Z...\r\n");
+    slow = 1E6 / (2.0 * cfg->homespeed) / (abs(cfg->zscale) / 1000.0); // [mm/sec]
+    if ( !home_move(0, 0, dz * 2 * (cfg->zmax - cfg->zmin) / 1000.0, cfg->homefast, HOME_Z) ||
+         !home_move(0, 0, -dz * back, cfg->homefast, 0) ||
+         !home_move(0, 0, dz * 2 * back, slow, HOME_Z) )
       return;
-    }
   }
 
+  printf("Home XY...\r\n");
+  slow = 1E6 / (2.0 * cfg->homespeed) / (abs(cfg->xscale) / 1000.0); // [mm/sec]
+  if ( !home_move(dx * 2 * (cfg->xmax - cfg->xmin) / 1000.0, dy * 2 * (cfg->ymax - cfg->ymin) / 1000.0, 0, cfg->homefast, HOME_XY) ||
+       !home_move(-dx * back, -dy * back, 0, cfg->homefast, 0) ||
+       !home_move(dx * 2 * back, dy * 2 * back, 0, slow, HOME_XY) )
+    return;
+
+  led2 = !xhome;
+  led3 = !yhome;
+  setPosition(x,y,z);
+  isHome = true;
+  TRACE(TRACE_INFO, EV_HOME_DONE, 0, 0, 0);
 }
 
 
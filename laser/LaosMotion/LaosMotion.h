@@ -28,6 +28,29 @@
 
 bool endstopReachedTest();
 
+// Job checkpoint: the job can be resumed at word "words" of the job file, with this parser state.
+// Checkpoints are taken at travel moves, once all motion before it has been executed.
+// The travel move sets the position again, after homing.
+typedef struct {
+  int words; // nr of job words before the checkpoint
+  long offset; // job file position of that word [bytes], see setJobOffset()
+  int power, speed; // laser power and mark speed
+  int ppi, pulse, blend; // ppi mode and corner rounding settings
+  int ofsx, ofsy, ofsz; // origin offset [micron]
+} tCheckpoint;
+
+// Motion counters, always on (reset per job)
+typedef struct {
+  uint32_t underruns;  // the stepper ran out of blocks (also counts the end of each job)
+  uint32_t reentries;  // step interrupt skipped because it was still busy
+  uint32_t isr_max;    // longest step interrupt [cpu cycles]
+  uint32_t rate_max;   // highest step rate [steps/sec]
+  uint32_t queue_full; // the job feeder found the planner queue full
+  uint32_t blocks;     // blocks executed
+  uint32_t laser_ms;   // laser on time [msec]
+  float est_time;      // planned time at the nominal speeds, without acceleration [sec]
+} tMotionStats;
+
 // the state of the laser OUTPUT
 #define LASEROFF 1
 #define LASERON 0
@@ -60,14 +83,20 @@ public:
   int queue(); // queued items
   void overrideSafety(bool enable);
   void clearBuffer();
+  void hold(); // feed hold: decelerate to a stop, keep the queue
+  void resume(); // resume after a feed hold
+  bool isHeld(); // stopped by a feed hold
   bool endstopReached();
-  bool clearEndstop();
+  bool clearEndstop(); // returns true if an endstop was reached
+  void setJobOffset(long ofs); // job file position of the next word (for the checkpoints)
+  int checkpoint(tCheckpoint *cp); // returns 1 and fills cp if a new checkpoint was reached
+  void restore(tCheckpoint *cp); // restore the parser state of a checkpoint (job file positioned at cp->offset)
+  void getStats(tMotionStats *s); // motion counters
+  void resetStats(); // reset the motion counters (at the start of a job)
+  void printStats(FILE *fp); // write the motion counters as text
 private:
 
 };
 
-  void timerMoveX();
-  void timerMoveY();
-
 
 #endif
@@ -37,7 +37,13 @@ typedef struct config_s
   int32_t maximum_feedrate_z;
   int32_t maximum_feedrate_e;
   float  acceleration;
+  float  acceleration_x; // per axis acceleration limits [mm/sec2]
+  float  acceleration_y;
+  float  acceleration_z;
+  float  acceleration_e;
+  float  rapid_acceleration; // acceleration of travel moves (laser off) [mm/sec2]
   float  junction_deviation; 
+  float  jerk; // jerk limit for S-curve ramps [mm/sec3], 0: constant acceleration ramps
 } config_t;
 
 #endif
\ No newline at end of file
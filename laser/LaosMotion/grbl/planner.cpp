@@ -32,6 +32,9 @@
 #include "planner.h"
 #include "stepper.h"
 #include "config.h"
+#include "LaosTrace.h"
+#include "LaosProf.h"
+#include "LaosSched.h"
 
 // The GRBL configuration (scaling etc)
 config_t config;
@@ -45,10 +48,13 @@ tTarget startpoint;
 static block_t block_buffer[BLOCK_BUFFER_SIZE];  // A ring buffer for motion instructions
 static volatile uint8_t block_buffer_head;       // Index of the next block to be pushed
 static volatile uint8_t block_buffer_tail;       // Index of the block to process now
+static volatile uint32_t blocks_queued;          // Nr of blocks queued since startup
+static volatile uint32_t blocks_done;            // Nr of blocks executed (or discarded) since startup
 
 static int32_t position[NUM_AXES];             // The current position of the tool in absolute steps
 static float previous_unit_vec[NUM_AXES];     // Unit vector of previous path line segment
 static float previous_nominal_speed;   // Nominal speed of previous path line segment
+static float previous_max_acceleration;  // Acceleration limit of previous path line segment (cutting or travel)
 
 static uint8_t acceleration_manager_enabled;   // Acceleration management active?
 
@@ -75,9 +81,15 @@ void plan_init() {
   config.maximum_feedrate_z = 60 * cfg->zspeed;
   config.maximum_feedrate_e = 60 * cfg->espeed;
   config.acceleration = cfg->accel; // [mm/sec2]
+  config.acceleration_x = (cfg->xaccel > 0 ? cfg->xaccel : config.acceleration); // [mm/sec2]
+  config.acceleration_y = (cfg->yaccel > 0 ? cfg->yaccel : config.acceleration);
+  config.acceleration_z = (cfg->zaccel > 0 ? cfg->zaccel : config.acceleration);
+  config.acceleration_e = (cfg->eaccel > 0 ? cfg->eaccel : config.acceleration);
+  config.rapid_acceleration = (cfg->rapidaccel > 0 ? cfg->rapidaccel : config.acceleration); // [mm/sec2]
   config.junction_deviation = cfg->tolerance/1000.0; //  convert tolerance from [micron] to [mm]
 
   config.junction_deviation = 0.05;
+  config.jerk = cfg->jerk; // [mm/sec3]
  //  config.steps_per_mm_x =  config.steps_per_mm_y =  config.steps_per_mm_z =  config.steps_per_mm_e = 200;
   // config.acceleration = 200;
   //config.maximum_feedrate_x =  config.maximum_feedrate_y =  config.maximum_feedrate_z =  config.maximum_feedrate_e = 60000;
@@ -86,7 +98,8 @@ void plan_init() {
   printf("steps_per_mm_z %f...\r\n", (float)config.steps_per_mm_z);
   printf("steps_per_mm_e %f...\r\n", (float)config.steps_per_mm_e);
   printf("accel %f...\r\n", (float)config.acceleration);
-  printf("Motion: double=%d, float=%d, block=%d\r\n", sizeof(double), sizeof(float), sizeof(block_t));
+  printf("accel x %f, y %f...\r\n", (float)config.acceleration_x, (float)config.acceleration_y);
+  printf("Motion: double=%d, float=%d, block=%d\r\n", (int)sizeof(double), (int)sizeof(float), (int)sizeof(block_t));
 
 }
 
@@ -115,6 +128,62 @@ static float estimate_acceleration_distance(float initial_rate, float target_rat
 }
 
 
+// The highest acceleration along a direction (unit vector) that keeps the acceleration of every axis
+// within its limit: the per axis limits are projected onto the direction, and never exceed max_acceleration
+// (config.acceleration, or config.rapid_acceleration for travel moves).
+static float axis_acceleration(const float *unit_vec, float max_acceleration) {
+  float acceleration = max_acceleration;
+  if (fabs(unit_vec[X_AXIS])*acceleration > config.acceleration_x)
+    acceleration = config.acceleration_x/fabs(unit_vec[X_AXIS]);
+  if (fabs(unit_vec[Y_AXIS])*acceleration > config.acceleration_y)
+    acceleration = config.acceleration_y/fabs(unit_vec[Y_AXIS]);
+  if (fabs(unit_vec[Z_AXIS])*acceleration > config.acceleration_z)
+    acceleration = config.acceleration_z/fabs(unit_vec[Z_AXIS]);
+  if (fabs(unit_vec[E_AXIS])*acceleration > config.acceleration_e)
+    acceleration = config.acceleration_e/fabs(unit_vec[E_AXIS]);
+  return(acceleration);
+}
+
+
+// The acceleration of the ramps of a block (mm/sec^2): max_acceleration limited by the per axis limits,
+// and for S-curves the mean acceleration (the peak is 1.5 times higher).
+static float ramp_acceleration(const float *unit_vec, float max_acceleration) {
+  float acceleration = axis_acceleration(unit_vec, max_acceleration);
+  if (config.jerk > 0)
+    acceleration /= 1.5;
+  return(acceleration);
+}
+
+
+// Mean acceleration for an S-curve ramp with a speed change of dv: the speed follows
+// v0 + dv*(3u^2-2u^3) over the ramp time T (u = t/T). The jerk is highest at the ends of the ramp
+// (6*dv/T^2), so the ramp is stretched until that is within config.jerk. The mean acceleration is never
+// higher than the block acceleration, which is already divided by 1.5 for S-curves (the peak acceleration
+// is 1.5 times the mean). The floor keeps the ramp distance defined when dv is (almost) zero.
+static float scurve_acceleration(float acceleration, float dv) {
+  return( max(min(acceleration, sqrt(config.jerk*fabs(dv)/6.0)), 1.0) );
+}
+
+
+// Distance [mm] of an S-curve ramp between speed v0 and v1 [mm/sec]
+static float scurve_distance(float acceleration, float v0, float v1) {
+  return( fabs(v1*v1-v0*v0)/(2*scurve_acceleration(acceleration, v1-v0)) );
+}
+
+
+// The highest speed [mm/sec] an S-curve ramp can reach from target_velocity [mm/sec] within the distance
+// at the jerk limit: with the jerk limited mean acceleration sqrt(jerk*dv/6), the ramp distance is
+// (2*v + dv)*sqrt(dv)*sqrt(1.5/jerk). With s = sqrt(dv) that is s^3 + 2*v*s = q, which is solved with
+// Newton's method, starting above the root (the iteration then converges from above).
+static float scurve_allowable_speed(float target_velocity, float distance) {
+  float p = 2*target_velocity, q = distance/sqrt(1.5/config.jerk);
+  float s = min(cbrt(q), q/max(p, 1E-3));
+  for (int i=0; i<5 && s > 0; i++)
+    s -= (s*s*s+p*s-q)/(3*s*s+p);
+  return( target_velocity+s*s );
+}
+
+
 /*                        + <- some maximum rate we don't care about
                          /|\
                         / | \
@@ -138,8 +207,12 @@ static float intersection_distance(float initial_rate, float final_rate, float a
 // NOTE: sqrt() reimplimented here from prior version due to improved planner logic. Increases speed
 // in time critical computations, i.e. arcs or rapid short lines from curves. Guaranteed to not exceed
 // BLOCK_BUFFER_SIZE calls per planner cycle.
+// With a jerk limit, the S-curve ramp also has to fit within the distance (speeds in mm/min).
 static float max_allowable_speed(float acceleration, float target_velocity, float distance) {
-  return( sqrt(target_velocity*target_velocity-2*acceleration*60*60*distance) );
+  float v = sqrt(target_velocity*target_velocity-2*acceleration*60*60*distance);
+  if (config.jerk > 0)
+    v = min(v, 60*scurve_allowable_speed(target_velocity/60, distance));
+  return( v );
 }
 
 
@@ -157,7 +230,7 @@ static void planner_reverse_pass_kernel(block_t *previous, block_t *current, blo
       // for max allowable speed if block is decelerating and nominal length is false.
       if ((!current->nominal_length_flag) && (current->max_entry_speed > next->entry_speed)) {
         current->entry_speed = min( current->max_entry_speed,
-          max_allowable_speed(-config.acceleration,next->entry_speed,current->millimeters));
+          max_allowable_speed(-current->acceleration,next->entry_speed,current->millimeters));
       } else {
         current->entry_speed = current->max_entry_speed;
       }
@@ -171,7 +244,7 @@ static void planner_reverse_pass_kernel(block_t *previous, block_t *current, blo
 // planner_recalculate() needs to go over the current plan twice. Once in reverse and once forward. This
 // implements the reverse pass.
 static void planner_reverse_pass() {
-  auto int8_t block_index = block_buffer_head;
+  int8_t block_index = block_buffer_head;
   block_t *block[3] = {NULL, NULL, NULL};
   while(block_index != block_buffer_tail) {
     block_index = prev_block_index( block_index );
@@ -195,7 +268,7 @@ static void planner_forward_pass_kernel(block_t *previous, block_t *current, blo
   if (!previous->nominal_length_flag) {
     if (previous->entry_speed < current->entry_speed) {
       float entry_speed = min( current->entry_speed,
-        max_allowable_speed(-config.acceleration,previous->entry_speed,previous->millimeters) );
+        max_allowable_speed(-previous->acceleration,previous->entry_speed,previous->millimeters) );
 
       // Check for junction speed change
       if (current->entry_speed != entry_speed) {
@@ -224,6 +297,40 @@ static void planner_forward_pass() {
 }
 
 
+// S-curve version of calculate_trapezoid_for_block(), used when a jerk limit is set.
+// The mean speed of an S-curve ramp equals the mean speed of a linear ramp with the same duration, so the
+// ramp distances follow from the usual v^2/(2a), with the (jerk limited) mean acceleration of each ramp.
+// If the ramps do not fit in the block, the highest peak speed at which they fit is searched (bisection),
+// the jerk limit is kept. A single ramp from entry to exit speed always fits, because the planner also
+// used the jerk limit to plan the junction speeds (max_allowable_speed()).
+static void calculate_scurve_for_block(block_t *block) {
+  float k = block->millimeters / block->step_event_count; // (mm/step)
+  float v0 = block->initial_rate*k/60.0, vp = block->nominal_rate*k/60.0, v1 = block->final_rate*k/60.0; // (mm/sec)
+
+  if (scurve_distance(block->acceleration, v0, vp)+scurve_distance(block->acceleration, vp, v1) > block->millimeters) {
+    float lo = max(v0, v1), hi = vp;
+    for (int i=0; i<16; i++) {
+      vp = (lo+hi)/2;
+      if (scurve_distance(block->acceleration, v0, vp)+scurve_distance(block->acceleration, vp, v1) > block->millimeters)
+        hi = vp;
+      else
+        lo = vp;
+    }
+    vp = lo;
+  }
+  float a_up = scurve_acceleration(block->acceleration, vp-v0), a_down = scurve_acceleration(block->acceleration, vp-v1);
+  int32_t accelerate_steps = ceil(estimate_acceleration_distance(v0, vp, a_up)/k);
+  accelerate_steps = min(accelerate_steps,block->step_event_count);
+  int32_t decelerate_steps = floor(estimate_acceleration_distance(vp, v1, -a_down)/k);
+  decelerate_steps = min(decelerate_steps,block->step_event_count-accelerate_steps);
+
+  block->peak_rate = vp/k;
+  block->accel_up = a_up/k;
+  block->accel_down = a_down/k;
+  block->accelerate_until = accelerate_steps;
+  block->decelerate_after = block->step_event_count-decelerate_steps;
+}
+
 /*                             STEPPER RATE DEFINITION
                                      +--------+   <- nominal_rate
                                     /          \
@@ -240,6 +347,7 @@ static void calculate_trapezoid_for_block(block_t *block, float entry_factor, fl
 
   block->initial_rate = ceil(block->nominal_rate*entry_factor); // (step/min)
   block->final_rate = ceil(block->nominal_rate*exit_factor); // (step/min)
+  if (config.jerk > 0) { calculate_scurve_for_block(block); return; }
   int32_t acceleration_per_minute = block->rate_delta*ACCELERATION_TICKS_PER_SECOND*60.0; // (step/min^2)
   int32_t accelerate_steps =
     ceil(estimate_acceleration_distance(block->initial_rate, block->nominal_rate, acceleration_per_minute));
@@ -340,6 +448,35 @@ void plan_clear_buffer(){
   while(plan_get_current_block()!=NULL) plan_discard_current_block();
 }
 
+// Re-plan the buffer from a complete stop (after a feed hold). The first block is reduced to the part
+// that is not executed yet, and its entry speed is set to zero.
+void plan_cycle_reinitialize(int32_t *steps_done, uint16_t pixels_done) {
+  block_t *block = plan_get_current_block();
+  int32_t step_event_count;
+  if (block == NULL) { return; }
+
+  block->steps_x -= steps_done[X_AXIS];
+  block->steps_y -= steps_done[Y_AXIS];
+  block->steps_z -= steps_done[Z_AXIS];
+  block->steps_e -= steps_done[E_AXIS];
+  step_event_count = max(block->steps_x, max(block->steps_y, block->steps_z));
+  step_event_count = max(step_event_count, (int32_t)block->steps_e);
+  if (step_event_count > 0 && step_event_count < block->step_event_count) {
+    // The path length per step event is the same, so the rates (steps/min) and ppi_step still apply
+    block->millimeters = (block->millimeters*step_event_count)/block->step_event_count;
+    block->step_event_count = step_event_count;
+  }
+  pixels_done = min(pixels_done, block->bitmap_len);
+  block->bitmap_ofs += pixels_done;
+  block->bitmap_len -= pixels_done;
+
+  block->entry_speed = 0.0;
+  block->max_entry_speed = 0.0;
+  block->nominal_length_flag = false;
+  block->recalculate_flag = true;
+  if (acceleration_manager_enabled) { planner_recalculate(); }
+}
+
 int plan_is_acceleration_manager_enabled() {
   return(acceleration_manager_enabled);
 }
@@ -347,6 +484,7 @@ int plan_is_acceleration_manager_enabled() {
 void plan_discard_current_block() {
   if (block_buffer_head != block_buffer_tail) {
     block_buffer_tail = next_block_index( block_buffer_tail );
+    blocks_done++;
   }
 }
 
@@ -359,11 +497,11 @@ block_t *plan_get_current_block() {
 // millimeters. Feed rate specifies the speed of the motion.
 void plan_buffer_line (tActionRequest *pAction)
 {
+  PROF_SCOPE(PROF_PLAN_BUFFER);
   float x;
   float y;
   float z;
   float feed_rate;
-  bool e_only = false;
   float speed_x, speed_y, speed_z, speed_e; // Nominal mm/minute for each axis
 
   x = pAction->target.x;
@@ -392,14 +530,19 @@ void plan_buffer_line (tActionRequest *pAction)
   int next_buffer_head = next_block_index( block_buffer_head );
 
   // If the buffer is full: good! That means we are well ahead of the robot.
-  // Rest here until there is room in the buffer.
-  while(block_buffer_tail == next_buffer_head) { sleep_mode(); }
+  // Rest here until there is room in the buffer, the other tasks (network, watchdog) keep running.
+  while(block_buffer_tail == next_buffer_head) { sched_run(); }
 
   // Prepare to set up new block
   block_t *block = &block_buffer[block_buffer_head];
 
   block->action_type = AT_MOVE;
+  block->accel_up = block->accel_down = 0;
   block->power = pAction->param;
+  block->bitmap_ofs = pAction->bitmap_ofs;
+  block->bitmap_len = pAction->bitmap_len;
+  block->ppi = pAction->ppi;
+  block->pulse = pAction->pulse;
 
   // Compute direction bits for this block
   block->direction_bits = 0;
@@ -414,7 +557,7 @@ void plan_buffer_line (tActionRequest *pAction)
   block->steps_z = labs(target[Z_AXIS]-position[Z_AXIS]);
   block->steps_e = labs(target[E_AXIS]-position[E_AXIS]);
   block->step_event_count = max(block->steps_x, max(block->steps_y, block->steps_z));
-  block->step_event_count = max(block->step_event_count, block->steps_e);
+  block->step_event_count = max(block->step_event_count, (int32_t)block->steps_e);
 
   // Bail if this is a zero-length block
   if (block->step_event_count == 0) { return; };
@@ -428,11 +571,15 @@ void plan_buffer_line (tActionRequest *pAction)
   block->millimeters = sqrt(square(delta_mm[X_AXIS]) + square(delta_mm[Y_AXIS]) +
                             square(delta_mm[Z_AXIS]));
   if (block->millimeters == 0)
-  {
-    e_only = true;
     block->millimeters = fabs(delta_mm[E_AXIS]);
-  }
   float inverse_millimeters = 1.0/block->millimeters;  // Inverse millimeters to remove multiple divides
+  // Compute path unit vector
+  float unit_vec[NUM_AXES];
+  unit_vec[X_AXIS] = delta_mm[X_AXIS]*inverse_millimeters;
+  unit_vec[Y_AXIS] = delta_mm[Y_AXIS]*inverse_millimeters;
+  unit_vec[Z_AXIS] = delta_mm[Z_AXIS]*inverse_millimeters;
+  unit_vec[E_AXIS] = delta_mm[E_AXIS]*inverse_millimeters;
+  block->ppi_step = (block->millimeters * 1000.0 * 1024.0) / block->step_event_count;
 
 //
 // Speed limit code from Marlin firmware
@@ -486,20 +633,16 @@ void plan_buffer_line (tActionRequest *pAction)
   // axes might step for every step event. Travel per step event is then sqrt(travel_x^2+travel_y^2).
   // To generate trapezoids with contant acceleration between blocks the rate_delta must be computed
   // specifically for each line to compensate for this phenomenon:
-  // Convert universal acceleration for direction-dependent stepper rate change parameter
+  // Convert universal acceleration for direction-dependent stepper rate change parameter.
+  // The acceleration along the path is limited so that no axis exceeds its own acceleration limit.
+  float max_acceleration = (pAction->ActionType == AT_MOVE ? config.rapid_acceleration : config.acceleration);
+  block->acceleration = ramp_acceleration(unit_vec, max_acceleration); // (mm/sec^2)
   block->rate_delta = ceil( block->step_event_count*inverse_millimeters *
-        config.acceleration*60.0 / ACCELERATION_TICKS_PER_SECOND ); // (step/min/acceleration_tick)
+        block->acceleration*60.0 / ACCELERATION_TICKS_PER_SECOND ); // (step/min/acceleration_tick)
 
   // Perform planner-enabled calculations
   if (acceleration_manager_enabled  )
   {
-    // Compute path unit vector
-    float unit_vec[NUM_AXES];
-
-    unit_vec[X_AXIS] = delta_mm[X_AXIS]*inverse_millimeters;
-    unit_vec[Y_AXIS] = delta_mm[Y_AXIS]*inverse_millimeters;
-    unit_vec[Z_AXIS] = delta_mm[Z_AXIS]*inverse_millimeters;
-
     // Compute maximum allowable entry speed at junction by centripetal acceleration approximation.
     // Let a circle be tangent to both previous and current path line segments, where the junction
     // deviation is defined as the distance from the junction to the closest edge of the circle,
@@ -524,17 +667,25 @@ void plan_buffer_line (tActionRequest *pAction)
         vmax_junction = min(previous_nominal_speed,block->nominal_speed);
         // Skip and avoid divide by zero for straight junctions at 180 degrees. Limit to min() of nominal speeds.
         if (cos_theta > -0.95) {
-          // Compute maximum junction velocity based on maximum acceleration and junction deviation
+          // Compute maximum junction velocity based on maximum acceleration and junction deviation.
+          // The centripetal acceleration points along the change of direction, so the per axis limits
+          // are projected onto that vector.
+          float change_vec[NUM_AXES];
+          float inverse_change = 1.0/sqrt(2.0+2.0*cos_theta); // |unit_vec-previous_unit_vec|, > 0.3 here
+          change_vec[X_AXIS] = (unit_vec[X_AXIS]-previous_unit_vec[X_AXIS])*inverse_change;
+          change_vec[Y_AXIS] = (unit_vec[Y_AXIS]-previous_unit_vec[Y_AXIS])*inverse_change;
+          change_vec[Z_AXIS] = (unit_vec[Z_AXIS]-previous_unit_vec[Z_AXIS])*inverse_change;
+          change_vec[E_AXIS] = 0;
           float sin_theta_d2 = sqrt(0.5*(1.0-cos_theta)); // Trig half angle identity. Always positive.
           vmax_junction = min(vmax_junction,
-            sqrt(config.acceleration*60*60 * config.junction_deviation * sin_theta_d2/(1.0-sin_theta_d2)) );
+            sqrt(axis_acceleration(change_vec, min(max_acceleration, previous_max_acceleration))*60*60 * config.junction_deviation * sin_theta_d2/(1.0-sin_theta_d2)) );
         }
       }
     }
     block->max_entry_speed = vmax_junction;
 
     // Initialize block entry speed. Compute based on deceleration to user-defined MINIMUM_PLANNER_SPEED.
-    float v_allowable = max_allowable_speed(-config.acceleration,MINIMUM_PLANNER_SPEED,block->millimeters);
+    float v_allowable = max_allowable_speed(-block->acceleration,MINIMUM_PLANNER_SPEED,block->millimeters);
     block->entry_speed = min(vmax_junction, v_allowable);
 
     // Initialize planner efficiency flags
@@ -552,6 +703,7 @@ void plan_buffer_line (tActionRequest *pAction)
     // Update previous path unit_vector and nominal speed
     memcpy(previous_unit_vec, unit_vec, sizeof(unit_vec)); // previous_unit_vec[] = unit_vec[]
     previous_nominal_speed = block->nominal_speed;
+    previous_max_acceleration = max_acceleration;
 
   } else {
     // Acceleration planner disabled. Set minimum that is required.
@@ -577,8 +729,11 @@ void plan_buffer_line (tActionRequest *pAction)
   // now that the options are set: make this a MOVE action.
   pAction->ActionType = AT_MOVE;
 
+  motion_stats.est_time += block->millimeters * 60.0 / block->nominal_speed; // job time estimate
+
   // Move buffer head
   block_buffer_head = next_buffer_head;
+  blocks_queued++;
   // Update position
   memcpy(position, target, sizeof(target)); // position[] = target[]
 
@@ -597,8 +752,8 @@ void plan_buffer_wait (tActionRequest *pAction)
   int next_buffer_head = next_block_index( block_buffer_head );
 
   // If the buffer is full: good! That means we are well ahead of the robot.
-  // Rest here until there is room in the buffer.
-  while(block_buffer_tail == next_buffer_head) { sleep_mode(); }
+  // Rest here until there is room in the buffer, the other tasks (network, watchdog) keep running.
+  while(block_buffer_tail == next_buffer_head) { sched_run(); }
 
   // Prepare to set up new block
   block_t *block = &block_buffer[block_buffer_head];
@@ -606,6 +761,8 @@ void plan_buffer_wait (tActionRequest *pAction)
   //TODO
 
   block->action_type = pAction->ActionType;
+  block->accel_up = block->accel_down = 0;
+  block->acceleration = config.acceleration;
   // every 50ms
   block->millimeters = 10;
   block->nominal_speed = 600;
@@ -624,6 +781,7 @@ void plan_buffer_wait (tActionRequest *pAction)
 
   // Move buffer head
   block_buffer_head = next_buffer_head;
+  blocks_queued++;
 
   if (acceleration_manager_enabled) { planner_recalculate(); }
   st_wake_up();
@@ -644,6 +802,8 @@ void plan_buffer_action(tActionRequest *pAction)
   case AT_WAIT:
     plan_buffer_wait (pAction);
     break;
+  default: // AT_BITMAP_SIMULATE is not executed
+    break;
   }
 }
 
@@ -676,7 +836,7 @@ void plan_set_current_position(tTarget *new_position)
   position[E_AXIS] = lround(new_position->e*(float)config.steps_per_mm_e);
   previous_nominal_speed = 0.0; // Resets planner junction speeds. Assumes start from rest.
   clear_vector_double(previous_unit_vec);
-  printf("Set Position: %d,%d,%d,%d\r\n", position[X_AXIS],  position[Y_AXIS],  position[Z_AXIS],  position[E_AXIS]);
+  TRACE(TRACE_INFO, EV_SET_POSITION, position[X_AXIS], position[Y_AXIS], position[Z_AXIS]);
   // Wait for all motion to stop and THEN set the actual stepper axis positions;
   // while( !mot->ready() );
   actpos_x =  position[X_AXIS];
@@ -714,10 +874,30 @@ uint8_t plan_queue_empty(void)
 // Return nr of items in the queue
 uint8_t plan_queue_items(void)
 {
- // BLOCK_BUFFER_SIZE;
   int len =  block_buffer_head - block_buffer_tail;
-  if ( len < 0 ) len = -len;
+  if ( len < 0 ) len += BLOCK_BUFFER_SIZE;
   return len;
 }
 
+// Distance to accelerate from rest to speed v [mm/sec] (or to stop from it), with the acceleration
+// plan_buffer_line() uses for this type of move [mm]
+float plan_ramp_distance(eActionType type, float ux, float uy, float v)
+{
+  float unit_vec[NUM_AXES] = { ux, uy, 0, 0 };
+  float acceleration = ramp_acceleration(unit_vec, type == AT_MOVE ? config.rapid_acceleration : config.acceleration);
+  if (config.jerk > 0)
+    return scurve_distance(acceleration, 0, v);
+  return v*v/(2*acceleration);
+}
 
+// Nr of blocks queued since startup
+uint32_t plan_blocks_queued(void)
+{
+  return blocks_queued;
+}
+
+// Nr of blocks executed (or discarded) since startup
+uint32_t plan_blocks_done(void)
+{
+  return blocks_done;
+}
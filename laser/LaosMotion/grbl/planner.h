@@ -71,6 +71,7 @@ typedef struct
   float entry_speed;                 // Entry speed at previous-current junction in mm/min
   float max_entry_speed;             // Maximum allowable junction entry speed in mm/min
   float millimeters;                 // The total travel of this block in mm
+  float acceleration;                // Acceleration along the path in mm/sec^2 (limited by the per axis limits)
   uint8_t recalculate_flag;           // Planner flag to recalculate trapezoids on entry junction
   uint8_t nominal_length_flag;        // Planner flag for nominal speed always reached
 
@@ -80,11 +81,18 @@ typedef struct
   int32_t rate_delta;                 // The steps/minute to add or subtract when changing speed (must be positive)
   uint32_t accelerate_until;          // The index of the step event on which to stop acceleration
   uint32_t decelerate_after;          // The index of the step event on which to start decelerating
+  float accel_up, accel_down;         // S-curve ramps: mean acceleration in steps/sec^2 (0: constant acceleration ramps)
+  float peak_rate;                    // S-curve ramps: highest step rate in steps/sec
 
   // extra
   uint8_t check_endstops; // for homing moves
   uint8_t options; // for further options (e.g. laser on/off, homing on axis, dwell, etc)
   uint16_t power; // laser power setpoint
+  uint16_t bitmap_ofs; // first bitmap pixel of this block (bitmap blocks only)
+  uint16_t bitmap_len; // nr of bitmap pixels covered by this block
+  uint16_t ppi; // pulse pitch [micron], 0 = continuous laser
+  uint16_t pulse; // pulse length in ppi mode [usec]
+  uint32_t ppi_step; // path length per step event [22.10 fixed point micron]
 } block_t;
 
 // This defines an action to enque, with its target position
@@ -92,6 +100,8 @@ typedef struct {
   eActionType ActionType;
   tTarget     target;
   uint16_t    param; // argument for the action
+  uint16_t    bitmap_ofs, bitmap_len; // pixel range of the bitmap for AT_BITMAP actions
+  uint16_t    ppi, pulse; // pulse pitch [micron] and pulse length [usec] for AT_LASER actions (ppi mode)
 } tActionRequest;
 
 
@@ -109,6 +119,10 @@ void plan_buffer_action(tActionRequest *pAction);
 
 void plan_clear_buffer();
 
+// Re-plan the buffer from a complete stop (after a feed hold). The first block is reduced to the part
+// that is not executed yet: steps_done[] steps per axis and pixels_done bitmap pixels are removed.
+void plan_cycle_reinitialize(int32_t *steps_done, uint16_t pixels_done);
+
 // Called when the current block is no longer needed. Discards the block and makes the memory
 // availible for new blocks.
 void plan_discard_current_block();
@@ -136,4 +150,12 @@ uint8_t plan_queue_empty(void);
 
 uint8_t plan_queue_items(void) ;
 
+// Nr of blocks queued and executed (or discarded) since startup
+uint32_t plan_blocks_queued(void);
+uint32_t plan_blocks_done(void);
+
+// Distance to accelerate from rest to speed v [mm/sec], or to stop from it, as planned for a move
+// of this type in direction (ux,uy) (unit vector) [mm]
+float plan_ramp_distance(eActionType type, float ux, float uy, float v);
+
 #endif
@@ -40,6 +40,8 @@
 #include "stepper.h"
 #include "config.h"
 #include "planner.h"
+#include "LaosProf.h"
+#include "LaosSched.h"
 
 
 #define TICKS_PER_MICROSECOND (1) // Ticker uses 1usec units
@@ -52,10 +54,14 @@ typedef enum {RAMP_UP, RAMP_MAX, RAMP_DOWN} tRamp;
 // Prototypes
 static void st_interrupt ();
 static void set_step_timer (uint32_t cycles);
+static void pixel_interrupt ();
+static void pixel_start ();
+static void pixel_stop ();
+static void pulse_end ();
 
 // Globals
 volatile unsigned char busy = 0;
-volatile static double p = cfg->pwmmin/100.0;
+volatile tMotionStats motion_stats;
 volatile int32_t actpos_x, actpos_y, actpos_z, actpos_e; // actual position
 
 // Locals
@@ -63,24 +69,48 @@ static block_t *current_block;  // A pointer to the block currently being traced
 static Ticker timer; // the periodic timer used to step
 static tFixedPt pwmofs; // the offset of the PWM value
 static tFixedPt pwmscale; // the scaling of the PWM value
+
+// Laser output: the PWM value is kept as a PWM1 match count, precalculated when a block starts.
+// The output registers are only written when the state or the match value really changes.
+static int32_t pwm_period;        // PWM1 period (MR0) [counts]
+static int32_t laser_match_off;   // match count with laser off (pwmmin)
+static int32_t laser_match_nom;   // match count at nominal speed for the current block
+static int32_t laser_match_min;   // match count at zero speed for the current block (power scaling)
+static volatile int32_t laser_match = 0; // match count for the actual speed
+static int32_t pwm_match = -1;    // match count in the PWM register (cache)
+static int laser_state = -1;      // state of the laser output (cache)
+static uint32_t laser_t0, laser_us; // laser on time: switch on time, usec not yet counted in motion_stats
+
+// PPI mode: the laser fires one pulse of fixed length every block->ppi micron of path length
+static Timeout pulse_timer;       // one-shot timer that ends the pulse
+static uint32_t ppi_dist;         // path length since the last pulse [22.10 micron]
+static volatile int pulse_on = 0; // a ppi pulse is running (until pulse_end)
 static volatile int running = 0;  // stepper irq is running
 
+// Feed hold: the step interrupt decelerates to a stop, the current block and the queue are kept
+#define HOLD_OFF      0
+#define HOLD_REQUEST  1 // decelerate from the next step event
+#define HOLD_DECEL    2 // decelerating
+#define HOLD_STOPPED  3 // stopped, the step interrupt is idle
+static volatile int hold = HOLD_OFF;
+
 static uint32_t direction_inv;    // invert mask for direction bits
 static uint32_t direction_bits;   // all axes direction (different ports)
 static uint32_t step_bits;        // all axis step bits
 static uint32_t step_inv;      // invert mask for the stepper bits
-static uint32_t nominal_rate; // [steps/min]
 static int32_t counter_x,       // Counter variables for the bresenham line tracer
                counter_y,
                counter_z;
 static int32_t counter_e, counter_l, pos_l; // extruder and laser
 static uint32_t step_events_completed; // The number of step events executed in the current block
+static uint32_t endstop_axes;     // homing block: step bits of the axes that move towards an end-stop
+static uint32_t endstop_hit;      // homing block: step bits of the axes that reached their end-stop
+static uint32_t endstop_expect;   // homing move: step bits of the axes that have to reach their end-stop
 
 // Variables used by the trapezoid generation
 //static uint32_t cycles_per_step_event;        // The number of machine cycles between each step event
 static uint32_t trapezoid_tick_cycle_counter; // The cycles since last trapezoid_tick. Used to generate ticks at a steady
                                               // pace without allocating a separate timer
-static uint32_t trapezoid_adjusted_rate;      // The current rate of step_events according to the trapezoid generator
 
 static tFixedPt  c;          // current clock cycle count [1/speed]
 static int32_t   c_min;      // minimal clock cycle count [at vnominal for this block]
@@ -91,6 +121,18 @@ static tRamp     ramp;        // state of state machine for ramping up/down
 extern unsigned char bitmap_bpp;
 extern unsigned long bitmap[], bitmap_width, bitmap_size;
 
+// Pixel clock: during the constant speed part of a bitmap line the laser is switched on time
+// (pixel boundaries are calculated from the nominal step rate), not on step events.
+#define PIXEL_MIN_PERIOD 20 // shortest pixel period we try to follow [usec]
+static Timeout pixel_timer;       // fires at the next pixel boundary
+static Timer pixel_time;          // free running time base [usec]
+static volatile int pixel_clock;  // pixel clock is running, pixel_interrupt() drives the laser
+static int32_t pixel_next;        // next pixel to show
+static int32_t pixel_end;         // end of the pixel range of this block
+static int32_t pixel_t0;          // time at pixel position pixel_p0 [usec]
+static int32_t pixel_p0;          // pixel position at pixel_t0 [16.16 pixels]
+static uint32_t pixel_period;     // time per pixel [16.16 usec]
+
 
 //         __________________________
 //        /|                        |\     _________________         ^
@@ -133,8 +175,13 @@ void st_init(void)
     pwmscale = div_f(to_fixed(cfg->pwmmax - cfg->pwmmin), to_fixed(100) );
   printf("ofs: %d, scale: %d\r\n", pwmofs, pwmscale);
   actpos_x = actpos_y = actpos_z = actpos_e = 0;
+  pixel_clock = 0;
+  pixel_time.start();
   st_wake_up();
   trapezoid_tick_cycle_counter = 0;
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // cycle counter for the interrupt time
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  st_reset_stats();
   st_go_idle();  // Start in the idle state
 }
 
@@ -170,23 +217,23 @@ static inline void  clear_all_step_pins (void)
 // check home sensor
 int hit_home_stop_x(int axis)
 {
-  return 1;
+  return xhome == cfg->xpol;
 }
 // check home sensor
 int hit_home_stop_y(int axis)
 {
-  return 1;
+  return yhome == cfg->ypol;
 }
-// check home sensor
+// check home sensor (either end of the z axis)
 int hit_home_stop_z(int axis)
 {
-  return 1;
+  return zmin == cfg->zpol || zmax == cfg->zpol;
 }
 
 // Start stepper again from idle state, starts the step timer at a default rate
 void st_wake_up()
 {
-  if ( ! running )
+  if ( ! running && hold == HOLD_OFF )
   {
     running = 1;
     set_step_timer(2000);
@@ -198,8 +245,11 @@ void st_wake_up()
 // (some delay might have to be implemented). Currently no motor switchoff is done.
 void st_go_idle()
 {
+  pixel_stop();
   timer.detach();
   running = 0;
+  if ( hold != HOLD_OFF )
+    hold = HOLD_STOPPED;
   clear_all_step_pins();
   laser_on(LASEROFF);
 //  printf("idle()..\r\n");
@@ -216,6 +266,7 @@ static inline int32_t calc_n (float speed, float alpha, float accel)
 // block begins. Calculates the length ofc the block (in events), step rate, slopes and trigger positions (when to accel, decel, etc.)
 static inline void trapezoid_generator_reset()
 {
+  PROF_SCOPE(PROF_TRAPEZOID);
   tFixedPt  c0;
 #define alpha (1.0)
 
@@ -241,7 +292,7 @@ static inline void trapezoid_generator_reset()
   ramp = RAMP_UP;
 
   accel_until = calc_n (current_block->nominal_rate/60.0, alpha, accel);
-  c_min = c0 * (sqrt(accel_until+1.0)-sqrt((float)accel_until));
+  c_min = (float)STEP_TIMER_FREQ * 60.0 / current_block->nominal_rate + 0.5; // nominal step interval, the ramp ends there
   accel_until = accel_until - n;
 
   decel_n = - calc_n (current_block->nominal_rate/60.0, alpha, accel);
@@ -266,33 +317,331 @@ static inline void trapezoid_generator_reset()
 //  return (TICKS_PER_MICROSECOND*1000000*6) / cycles * 10;
 //}
 
+// A match count within the PWM period. The counts are calculated in 64 bit: at a low
+// laser.pwm.freq the period is large enough to overflow a product in 32 bit.
+static inline int32_t pwm_clamp (int64_t m)
+{
+   return m < 0 ? 0 : ( m > pwm_period ? pwm_period : (int32_t)m );
+}
+
+// Precalculate the laser PWM match counts for the power of the current block
+static inline void set_block_power ()
+{
+   laser_match_nom = pwm_clamp(laser_match_off + (int64_t)pwm_period * (cfg->pwmmax - cfg->pwmmin) * current_block->power / 1000000);
+   laser_match_min = pwm_clamp(laser_match_off + (int64_t)(laser_match_nom - laser_match_off) * cfg->scalemin / 100);
+}
+
+// Update the laser power for the current step interval "cycles"
+// The power is scaled with the actual speed (c_min/cycles is the fraction of the nominal speed),
+// but never below the configured minimum fraction. This prevents burning corners during acceleration.
+static inline void set_laser_power (uint32_t cycles)
+{
+   uint32_t cmin;
+   if ( current_block == NULL )
+     return;
+   cmin = to_int(c_min);
+   if ( cycles <= cmin || cmin > 0x7fff )
+     laser_match = laser_match_nom;
+   else
+     laser_match = laser_match_min + (int32_t)((int64_t)(laser_match_nom - laser_match_min) * cmin / cycles);
+}
+
+// S-curve ramps (block->accel_up > 0): the speed follows v0 + dv*(3u^2-2u^3) with u = t/T, see planner.cpp.
+// The speed is updated ACCELERATION_TICKS_PER_SECOND times per second, the time is the sum of the step intervals.
+static float     s_v0, s_dv, s_vmin;  // ramp start speed, speed change and lowest speed [steps/sec]
+static float     s_T;                 // ramp time [usec]
+static uint32_t  s_t, s_tick;         // time since the start of the ramp, and of the next speed update [usec]
+static float     s_c, s_frac;         // exact step interval, and the part of it not used by the timer yet [usec]
+
+static void scurve_ramp (float v0, float v1, float accel)
+{
+  s_v0 = v0;
+  s_dv = v1 - v0;
+  s_T = 1E6 * fabs(s_dv) / accel;
+  s_vmin = max(sqrt(accel/2.0), MINIMUM_STEPS_PER_MINUTE/60.0); // first step from rest takes sqrt(2/a)
+  s_t = s_tick = 0;
+}
+
+// The speed at the middle of the update interval: it is the mean speed of the interval, so the
+// ramp covers the distance the planner reserved for it (and does not run out of steps while decelerating).
+static inline float scurve_speed ()
+{
+  float u, v = s_v0 + s_dv;
+  uint32_t t = s_t + 500000 / ACCELERATION_TICKS_PER_SECOND;
+  if ( t < s_T )
+  {
+    u = t / s_T;
+    v = s_v0 + s_dv * u * u * (3.0 - 2.0 * u);
+  }
+  return max(v, s_vmin);
+}
+
+// Next step interval during a ramp: the timer runs at whole usecs, the rest is carried to the next
+// steps. The mean step rate is then exact, truncating would make the ramps run fast and overshoot.
+static inline void scurve_interval ()
+{
+  int32_t new_c;
+  s_frac += s_c;
+  new_c = s_frac;
+  s_frac -= new_c;
+  if ( new_c != to_int(c) )
+    set_step_timer (new_c);
+  c = to_fixed(new_c);
+}
+
+// Initialize the S-curve generator for a new block
+static void scurve_reset ()
+{
+  c_min = to_fixed((int32_t)(60E6 / current_block->nominal_rate));
+  ramp = RAMP_UP;
+  scurve_ramp(current_block->initial_rate/60.0, current_block->peak_rate, current_block->accel_up);
+  s_c = 1E6 / scurve_speed();
+  s_frac = s_c;
+  c = to_fixed((int32_t)s_frac);
+  s_frac -= to_int(c);
+  set_step_timer(to_int(c));
+}
+
+// Update the S-curve generator after a step
+static inline void scurve_step ()
+{
+  int32_t new_c;
+
+  s_t += to_int(c);
+  if ( ramp == RAMP_UP && step_events_completed >= current_block->accelerate_until &&
+       current_block->decelerate_after > current_block->accelerate_until )
+  {
+    ramp = RAMP_MAX;
+    s_c = 1E6 / current_block->peak_rate;
+    new_c = s_c;
+    if ( new_c != to_int(c) )
+      set_step_timer (new_c);
+    c = to_fixed(new_c);
+    if ( c <= c_min )
+      pixel_start();
+    return;
+  }
+  if ( ramp != RAMP_DOWN && step_events_completed >= current_block->decelerate_after )
+  {
+    pixel_stop();
+    ramp = RAMP_DOWN;
+    scurve_ramp(1E6 / s_c, current_block->final_rate/60.0, current_block->accel_down);
+  }
+  if ( ramp != RAMP_MAX )
+  {
+    if ( s_t >= s_tick )
+    {
+      s_tick = s_t + 1000000 / ACCELERATION_TICKS_PER_SECOND;
+      s_c = 1E6 / scurve_speed();
+    }
+    scurve_interval();
+  }
+}
+
 // Set the step timer. Note: this starts the ticker at an interval of "cycles"
 static inline void set_step_timer (uint32_t cycles)
 {
+   if ( cycles > 0 && STEP_TIMER_FREQ / cycles > motion_stats.rate_max )
+     motion_stats.rate_max = STEP_TIMER_FREQ / cycles;
    timer.attach_us(&st_interrupt,cycles);
-   // p = to_double(pwmofs + mul_f( pwmscale, ((power>>6) * c_min) / ((10000>>6)*cycles) ) );
-   // p = ( to_double(c_min) * current_block->power) / ( 10000.0 * (double)cycles);
-  // p = (60E6/nominal_rate) / cycles; // nom_rate is steps/minute,
-   //printf("%f,%f,%f\r\n", (float)(60E6/nominal_rate), (float)cycles, (float)p);
-  // printf("%d: %f %f\r\n", (int)current_block->power, (float)p, (float)c_min/(float(c) ));
-   p = (double)(cfg->pwmmin/100.0 + ((current_block->power/10000.0)*((cfg->pwmmax - cfg->pwmmin)/100.0)));
+   set_laser_power(cycles);
 }
 
 void clear_current_block(){
+  pixel_stop();
   current_block = NULL;
+  if ( hold != HOLD_OFF )
+  {
+    hold = HOLD_OFF;
+    st_wake_up();
+  }
 }
 
+// Decelerate to a stop at the acceleration of the current block (feed hold).
+// The block boundaries are ignored, the deceleration continues in the next block.
+static inline void hold_step ()
+{
+  tFixedPt new_c;
+  if ( hold == HOLD_REQUEST )
+  {
+    hold = HOLD_DECEL;
+    pixel_stop();
+    ramp = RAMP_DOWN;
+    n = - calc_n(STEP_TIMER_FREQ / (float)to_int(c), 1.0, current_block->rate_delta*ACCELERATION_TICKS_PER_SECOND / 60.0);
+  }
+  if ( n >= -1 )
+  {
+    hold = HOLD_STOPPED;
+    return;
+  }
+  new_c = c - (c<<1) / (4*n+1);
+  if (to_int(new_c) != to_int(c))
+    set_step_timer (to_int(new_c));
+  c = new_c;
+}
+
+// Reset the motion counters
+void st_reset_stats()
+{
+  memset((void*)&motion_stats, 0, sizeof(motion_stats));
+}
+
+// Request a feed hold. The step interrupt decelerates and stops, the laser is off from now on
+// (the hold may be caused by an open cover).
+void st_feed_hold()
+{
+  if ( hold != HOLD_OFF )
+    return;
+  __disable_irq();
+  hold = ( running ? HOLD_REQUEST : HOLD_STOPPED );
+  pixel_stop();
+  laser_on(LASEROFF);
+  __enable_irq();
+}
+
+int st_is_held()
+{
+  return hold == HOLD_STOPPED;
+}
+
+// A homing move is queued: the axes count as missed until its block reaches their end-stops,
+// so a move the planner drops (no steps) is reported as well
+void st_endstops_expect(uint32_t axes)
+{
+  endstop_expect = axes;
+  endstop_hit = 0;
+}
+
+// Axes of the last homing move that did not reach their end-stop
+uint32_t st_endstops_missed()
+{
+  return endstop_expect & ~endstop_hit;
+}
+
+// Resume after a feed hold: the rest of the current block and the queue are re-planned from rest.
+// Only once the motion is stopped (st_is_held()).
+void st_feed_resume()
+{
+  int32_t done[NUM_AXES];
+  uint16_t pixels = 0;
+  int32_t half;
+  if ( hold != HOLD_STOPPED )
+    return;
+  memset(done, 0, sizeof(done));
+  if ( current_block != NULL )
+  {
+    // steps already taken per axis, from the state of the bresenham tracer
+    half = current_block->step_event_count >> 1;
+    done[X_AXIS] = ((int64_t)step_events_completed * current_block->steps_x - half - counter_x) / current_block->step_event_count;
+    done[Y_AXIS] = ((int64_t)step_events_completed * current_block->steps_y - half - counter_y) / current_block->step_event_count;
+    done[Z_AXIS] = ((int64_t)step_events_completed * current_block->steps_z - half - counter_z) / current_block->step_event_count;
+    done[E_AXIS] = ((int64_t)step_events_completed * current_block->steps_e - half - counter_e) / current_block->step_event_count;
+    if ( current_block->options == OPT_BITMAP || current_block->options == OPT_BITMAP_TESTRUN )
+      pixels = pos_l - current_block->bitmap_ofs;
+    current_block = NULL; // the step interrupt starts the remaining part as a new block
+  }
+  plan_cycle_reinitialize(done, pixels);
+  hold = HOLD_OFF;
+  st_wake_up();
+}
+
+// Laser state for pixel pos of the current bitmap line
+// lines in negative X direction are read from the end of the bitmap
+static inline int bitmap_laser(int32_t pos)
+{
+  int32_t b = (current_block->direction_bits & (1<<X_DIRECTION_BIT)) ? bitmap_width - 1 - pos : pos;
+  return ! (bitmap[b / 32] & (1 << (b % 32)));
+}
+
+// Start the pixel clock for the current bitmap block, at nominal speed (called from the step interrupt)
+// The time base is synchronised to the pixel position of the bresenham tracer
+static void pixel_start()
+{
+  uint64_t period;
+  if ( !cfg->pixelclock || current_block->options != OPT_BITMAP || !current_block->bitmap_len )
+    return;
+  // c_min is [22.10 usec/step], period is [16.16 usec/pixel]
+  period = ((uint64_t)current_block->step_event_count * c_min << 6) / current_block->bitmap_len;
+  if ( period < (PIXEL_MIN_PERIOD << 16) || period >= 0x80000000UL )
+    return;
+  pixel_period = period;
+  pixel_t0 = pixel_time.read_us();
+  pixel_p0 = (pos_l << 16) + (((int64_t)(counter_l + current_block->step_event_count) << 16) / current_block->step_event_count);
+  pixel_next = pos_l + 1;
+  pixel_end = current_block->bitmap_ofs + current_block->bitmap_len;
+  pixel_clock = 1;
+  pixel_timer.attach_us(&pixel_interrupt, ((uint64_t)((pixel_next << 16) - pixel_p0) * pixel_period) >> 32);
+}
+
+// Stop the pixel clock, the step interrupt drives the laser again
+static void pixel_stop()
+{
+  if ( pixel_clock )
+  {
+    pixel_clock = 0;
+    pixel_timer.detach();
+  }
+}
+
+// Pixel clock interrupt: show the next pixel and schedule the following pixel boundary.
+// Boundaries are calculated from the time base, so rounding errors do not accumulate.
+static void pixel_interrupt()
+{
+  int32_t wait;
+  if ( !pixel_clock || current_block == NULL || hold != HOLD_OFF )
+    return;
+  if ( pixel_next >= pixel_end )
+  {
+    pixel_clock = 0;
+    return;
+  }
+  laser_on( bitmap_laser(pixel_next) );
+  pixel_next++;
+  wait = pixel_t0 + (int32_t)(((int64_t)((pixel_next << 16) - pixel_p0) * pixel_period) >> 32) - pixel_time.read_us();
+  pixel_timer.attach_us(&pixel_interrupt, wait > 1 ? wait : 1);
+}
+
+// Read the PWM period and switch the laser off (call after the PWM output is initialized)
+void laser_init()
+{
+  pwm_period = LPC_PWM1->MR0;
+  laser_match_off = laser_match = pwm_clamp((int64_t)pwm_period * cfg->pwmmin / 100);
+  pwm_match = laser_state = -1;
+  laser_on(LASEROFF);
+}
+
+// Switch the laser on or off, at the power for the actual speed
 void laser_on(int state)
 {
-  if(state==LASERON){
-    pwm = p;
-    *laser=LASERON;
-  }else{
-    pwm = cfg->pwmmin/100.0;
-    *laser=LASEROFF;
+  int32_t m = ( state == LASERON ? laser_match : laser_match_off );
+  if ( m != pwm_match )
+  {
+    LPC_PWM1->LASER_PWM_MR = m;
+    LPC_PWM1->LER |= LASER_PWM_LER;
+    pwm_match = m;
+  }
+  if ( state != laser_state )
+  {
+    if ( state == LASERON )
+      laser_t0 = pixel_time.read_us();
+    else if ( laser_state == LASERON )
+    {
+      laser_us += pixel_time.read_us() - laser_t0;
+      motion_stats.laser_ms += laser_us / 1000;
+      laser_us %= 1000;
+    }
+    *laser = state;
+    laser_state = state;
   }
 }
 
+// End of a ppi pulse
+static void pulse_end()
+{
+  pulse_on = 0;
+  laser_on(LASEROFF);
+}
+
 // "The Stepper Driver Interrupt" - This timer interrupt is the workhorse of Grbl. It is  executed at the rate set with
 // set_step_timer. It pops blocks from the block_buffer and executes them by pulsing the stepper pins appropriately.
 // It is supported by The Stepper Port Reset Interrupt which it uses to reset the stepper port after each pulse.
@@ -301,8 +650,10 @@ static  void st_interrupt (void)
 {
   // TODO: Check if the busy-flag can be eliminated by just disabeling this interrupt while we are in it
 
-  if(busy){ /*printf("busy!\r\n"); */ return; } // The busy-flag is used to avoid reentering this interrupt
+  if(busy){ motion_stats.reentries++; return; } // The busy-flag is used to avoid reentering this interrupt
   busy = 1;
+  PROF_SCOPE(PROF_STEP_ISR);
+  uint32_t isr_start = DWT->CYCCNT;
 
   // Set the direction pins a cuple of nanoseconds before we step the steppers
   //STEPPING_PORT = (STEPPING_PORT & ~DIRECTION_MASK) | (out_bits & DIRECTION_MASK);
@@ -319,20 +670,38 @@ static  void st_interrupt (void)
     // Anything in the buffer?
     current_block = plan_get_current_block();
     if (current_block != NULL) {
-      trapezoid_generator_reset();
+      tFixedPt c_hold = c;
+      if ( current_block->accel_up > 0 )
+        scurve_reset();
+      else
+        trapezoid_generator_reset();
+      if ( hold == HOLD_DECEL ) // keep decelerating from the actual speed
+      {
+        c = c_hold;
+        hold = HOLD_REQUEST;
+      }
+      set_block_power();
+      if ( current_block->ppi && !pulse_on ) // after a continuous cut: off until the first pulse
+        laser_on(LASEROFF);
+      set_step_timer(to_int(c)); // the ramps only update the timer when to_int(c) changes (also sets the laser power)
       counter_x = -(current_block->step_event_count >> 1);
       counter_y = counter_x;
       counter_z = counter_x;
       counter_e = counter_x;
-      counter_l = counter_x;
-      pos_l = 0; // reset laser bitmap counter
+      counter_l = -current_block->step_event_count; // pos_l advances at the end of each pixel
+      pos_l = current_block->bitmap_ofs; // reset laser bitmap counter
       step_events_completed = 0;
       direction_bits = current_block->direction_bits ^ direction_inv;
       set_direction_pins ();
       step_bits = 0;
+      endstop_hit = 0;
+      endstop_axes = (current_block->steps_x ? (1<<X_STEP_BIT) : 0) |
+                     (current_block->steps_y ? (1<<Y_STEP_BIT) : 0) |
+                     (current_block->steps_z ? (1<<Z_STEP_BIT) : 0);
     }
     else
     {
+      motion_stats.underruns++;
       st_go_idle();
     }
   }
@@ -344,8 +713,9 @@ static  void st_interrupt (void)
    // this block is a bitmap engraving line, read laser on/off status from buffer
    if ( current_block->options == OPT_BITMAP )
    {
-      laser_on( ! (bitmap[pos_l / 32] & (1 << (pos_l % 32))) );
-      counter_l += bitmap_width;
+      if ( !pixel_clock )
+        laser_on( hold == HOLD_OFF ? bitmap_laser(pos_l) : LASEROFF );
+      counter_l += current_block->bitmap_len;
      //  printf("%d %d %d: %d %d %c\r\n", bitmap_width, pos_l, counter_l,  pos_l / 32, pos_l % 32, (*laser ?  '1' : '0' ));
       if (counter_l > 0)
       {
@@ -357,7 +727,7 @@ static  void st_interrupt (void)
    else if ( current_block->options == OPT_BITMAP_TESTRUN )
    {
       laser_on (LASEROFF);
-      counter_l += bitmap_width;
+      counter_l += current_block->bitmap_len;
      //  printf("%d %d %d: %d %d %c\r\n", bitmap_width, pos_l, counter_l,  pos_l / 32, pos_l % 32, (*laser ?  '1' : '0' ));
       if (counter_l > 0)
       {
@@ -366,31 +736,66 @@ static  void st_interrupt (void)
         pos_l++;
       }
    }
+   else if ( current_block->ppi && (current_block->options & OPT_LASER_ON) )
+   {
+      // fire a pulse every ppi micron, the distance carries over to the next block
+      ppi_dist += current_block->ppi_step;
+      if ( ppi_dist >= (uint32_t)to_fixed(current_block->ppi) )
+      {
+        ppi_dist -= to_fixed(current_block->ppi);
+        if ( ppi_dist >= (uint32_t)to_fixed(current_block->ppi) ) // more than one pitch per step: do not queue up
+          ppi_dist = 0;
+        if ( hold == HOLD_OFF )
+        {
+          laser_on(LASERON);
+          pulse_on = 1;
+          pulse_timer.attach_us(&pulse_end, current_block->pulse);
+        }
+      }
+   }
    else
    {
-     laser_on ( current_block->options & OPT_LASER_ON ? LASERON : LASEROFF);
+     ppi_dist = 0;
+     laser_on ( (current_block->options & OPT_LASER_ON) && hold == HOLD_OFF ? LASERON : LASEROFF);
    }
 
     if (current_block->action_type == AT_MOVE)
     {
+      // This is a homing block: an axis stops as soon as its end-stop is triggered
+      if (current_block->check_endstops)
+      {
+        if ( (endstop_axes & (1<<X_STEP_BIT)) && hit_home_stop_x (direction_bits & (1<<X_DIRECTION_BIT)) )
+          endstop_hit |= (1<<X_STEP_BIT);
+        if ( (endstop_axes & (1<<Y_STEP_BIT)) && hit_home_stop_y (direction_bits & (1<<Y_DIRECTION_BIT)) )
+          endstop_hit |= (1<<Y_STEP_BIT);
+        if ( (endstop_axes & (1<<Z_STEP_BIT)) && hit_home_stop_z (direction_bits & (1<<Z_DIRECTION_BIT)) )
+          endstop_hit |= (1<<Z_STEP_BIT);
+      }
+
       // Execute step displacement profile by bresenham line algorithm
       step_bits = 0;
       counter_x += current_block->steps_x;
       if (counter_x > 0) {
-        actpos_x +=  ( (current_block->direction_bits & (1<<X_DIRECTION_BIT))? -1 : 1 );
-        step_bits |= (1<<X_STEP_BIT);
+        if ( !(endstop_hit & (1<<X_STEP_BIT)) ) {
+          actpos_x +=  ( (current_block->direction_bits & (1<<X_DIRECTION_BIT))? -1 : 1 );
+          step_bits |= (1<<X_STEP_BIT);
+        }
         counter_x -= current_block->step_event_count;
       }
       counter_y += current_block->steps_y;
       if (counter_y > 0) {
-        actpos_y +=  ( (current_block->direction_bits & (1<<Y_DIRECTION_BIT))? -1 : 1 );
-        step_bits |= (1<<Y_STEP_BIT);
+        if ( !(endstop_hit & (1<<Y_STEP_BIT)) ) {
+          actpos_y +=  ( (current_block->direction_bits & (1<<Y_DIRECTION_BIT))? -1 : 1 );
+          step_bits |= (1<<Y_STEP_BIT);
+        }
         counter_y -= current_block->step_event_count;
       }
       counter_z += current_block->steps_z;
       if (counter_z > 0) {
-        actpos_z +=  ( (current_block->direction_bits & (1<<Z_DIRECTION_BIT))? -1 : 1 );
+        if ( !(endstop_hit & (1<<Z_STEP_BIT)) ) {
+          actpos_z +=  ( (current_block->direction_bits & (1<<Z_DIRECTION_BIT))? -1 : 1 );
           step_bits |= (1<<Z_STEP_BIT);
+        }
         counter_z -= current_block->step_event_count;
       }
 
@@ -405,25 +810,23 @@ static  void st_interrupt (void)
       step_events_completed++; // Iterate step events
 
       // This is a homing block, keep moving until all end-stops are triggered
-      if (current_block->check_endstops)
+      if (current_block->check_endstops && endstop_hit == endstop_axes)
       {
-        if ( (current_block->steps_x && hit_home_stop_x (direction_bits & (1<<X_DIRECTION_BIT)) ) ||
-             (current_block->steps_y && hit_home_stop_y (direction_bits & (1<<Y_DIRECTION_BIT)) ) ||
-             (current_block->steps_z && hit_home_stop_z (direction_bits & (1<<Z_DIRECTION_BIT)) )
-           )
-        {
-          step_events_completed = current_block->step_event_count;
-          step_bits = 0;
-        }
+        step_events_completed = current_block->step_event_count;
+        step_bits = 0;
       }
 
 
       // While in block steps, update acceleration profile
-      if (step_events_completed < current_block->step_event_count)
+      if (step_events_completed < (uint32_t)current_block->step_event_count)
       {
         tFixedPt new_c;
 
-        switch (ramp)
+        if ( hold != HOLD_OFF )
+          hold_step();
+        else if ( current_block->accel_up > 0 )
+          scurve_step();
+        else switch (ramp)
         {
           case RAMP_UP:
           {
@@ -437,6 +840,7 @@ static  void st_interrupt (void)
             {
               new_c = c_min;
               ramp = RAMP_MAX;
+              pixel_start();
             }
 
             if (to_int(new_c) != to_int(c))
@@ -450,6 +854,7 @@ static  void st_interrupt (void)
           case RAMP_MAX:
             if (step_events_completed >= current_block->decelerate_after)
             {
+              pixel_stop();
               ramp = RAMP_DOWN;
               n = decel_n;
             }
@@ -468,8 +873,10 @@ static  void st_interrupt (void)
         n++;
       } else {
         // If current block is finished, reset pointer
+        pixel_stop();
         current_block = NULL;
         plan_discard_current_block();
+        motion_stats.blocks++;
       }
     }
   }
@@ -481,6 +888,18 @@ static  void st_interrupt (void)
   }
 
   clear_all_step_pins (); // clear the pins, assume that we spend enough CPU cycles in the previous statements for the steppers to react (>1usec)
+
+  // stopped by a feed hold: keep the current block, wait for st_feed_resume()
+  if ( hold == HOLD_STOPPED && running )
+  {
+    timer.detach();
+    running = 0;
+    pixel_stop();
+    laser_on(LASEROFF);
+  }
+  isr_start = DWT->CYCCNT - isr_start;
+  if ( isr_start > motion_stats.isr_max )
+    motion_stats.isr_max = isr_start;
   busy=0;
 
 }
@@ -489,6 +908,6 @@ static  void st_interrupt (void)
 // Block until all buffered steps are executed
 void st_synchronize()
 {
-  while(plan_get_current_block()) { sleep_mode(); }
+  while(plan_get_current_block()) { sched_run(); }
 }
 
@@ -26,7 +26,9 @@ extern volatile int32_t actpos_x, actpos_y, actpos_z, actpos_e;
 
 // from nuts_bolts.h:
 #define square(x) ((x)*(x))
+#ifndef sleep_mode
 #define sleep_mode(x) do {} while (0)
+#endif
 // #define sei(x)
 
 #define NUM_AXES 4
@@ -115,6 +117,22 @@ void clear_current_block();
 // to notify the subsystem that it is time to go to work.
 void st_wake_up();
 
+// Feed hold: decelerate to a stop along the planned path, keep the remaining blocks.
+// Resume re-plans from the stop position and continues.
+void st_feed_hold();
+void st_feed_resume();
+int st_is_held(); // true if the motion is stopped by a feed hold
+
+// Homing: call st_endstops_expect() before queueing the move, st_endstops_missed() returns the
+// step bits (1<<X_STEP_BIT, ...) of the expected axes that did not reach their end-stop
+void st_endstops_expect(uint32_t axes);
+uint32_t st_endstops_missed();
+
+// Motion counters (tMotionStats, see LaosMotion.h)
+extern volatile tMotionStats motion_stats;
+void st_reset_stats();
+
+void laser_init();
 void laser_on(int state);
 
 #endif
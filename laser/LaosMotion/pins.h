@@ -25,6 +25,8 @@ extern DigitalIn zmax;
 
 // laser
 extern PwmOut pwm;                // O1: PWM (Yellow)
+#define LASER_PWM_MR MR5        // p22 is PWM1.5: match register and latch enable bit used by the laser driver
+#define LASER_PWM_LER (1<<5)
 //extern DigitalOut laser_enable;   // O2: enable laser
 //extern DigitalOut o3;              // 03: NC
 
@@ -0,0 +1,101 @@
+/**
+ * LaosProf.cpp
+ * Execution time profiling of code regions
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "LaosProf.h"
+
+#if PROFILE
+
+typedef struct {
+  uint32_t count;
+  uint32_t min, max; // [ticks]
+  uint64_t sum;      // [ticks]
+  uint32_t hist[PROF_BUCKETS];
+} tProfRegion;
+
+static tProfRegion regions[PROF_COUNT];
+
+#define PR(id, name) name,
+static const char *names[] = { PROF_TABLE };
+#undef PR
+
+/**
+*** Add a measurement to a region (on the LPC1768, st_init() starts the cycle counter)
+**/
+void prof_add(int region, uint32_t ticks)
+{
+  tProfRegion *r = &regions[region];
+  int b = 0;
+  if ( r->count == 0 || ticks < r->min )
+    r->min = ticks;
+  if ( ticks > r->max )
+    r->max = ticks;
+  r->count++;
+  r->sum += ticks;
+  if ( ticks >= 32 )
+    b = 27 - __builtin_clz(ticks); // 32..63 ticks: bucket 1
+  if ( b >= PROF_BUCKETS )
+    b = PROF_BUCKETS - 1;
+  r->hist[b]++;
+}
+
+/**
+*** Clear all regions
+**/
+void prof_reset()
+{
+  for (int i=0; i<PROF_COUNT; i++)
+  {
+    tProfRegion *r = &regions[i];
+    r->count = r->min = r->max = 0;
+    r->sum = 0;
+    for (int b=0; b<PROF_BUCKETS; b++)
+      r->hist[b] = 0;
+  }
+}
+
+/**
+*** Write the statistics of all regions: min/mean/max, and the histogram
+*** (nr of runs per bucket, with the upper limit of each bucket in ticks)
+**/
+void prof_report(FILE *fp)
+{
+  fprintf(fp, "profile [%d ticks/usec]\r\n", (int)PROF_TICKS_PER_US);
+  for (int i=0; i<PROF_COUNT; i++)
+  {
+    tProfRegion *r = &regions[i];
+    if ( r->count == 0 )
+      continue;
+    fprintf(fp, "%s: n=%lu min=%lu mean=%lu max=%lu ticks\r\n", names[i], (unsigned long)r->count,
+      (unsigned long)r->min, (unsigned long)(r->sum / r->count), (unsigned long)r->max);
+    for (int b=0; b<PROF_BUCKETS; b++)
+    {
+      if ( r->hist[b] == 0 )
+        continue;
+      if ( b == PROF_BUCKETS - 1 )
+        fprintf(fp, "  >=%lu: %lu\r\n", 1UL << (b+4), (unsigned long)r->hist[b]);
+      else
+        fprintf(fp, "  <%lu: %lu\r\n", 1UL << (b+5), (unsigned long)r->hist[b]);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * LaosProf.h
+ * Execution time profiling of code regions
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * PROF_SCOPE() measures the time from that line to the end of the enclosing block,
+ * and adds it to the min/max/mean and a histogram of the region.
+ * On the LPC1768 the time is read from the DWT cycle counter [cpu cycles], on other
+ * targets (host builds) from clock_gettime() [nsec].
+ * A region must only be entered from one context (either an interrupt or the main loop).
+ * Profiling is left out completely, unless PROFILE is set to 1 (below, or with -DPROFILE=1).
+ *
+ @code
+   void plan_buffer_line(tActionRequest *pAction)
+   {
+     PROF_SCOPE(PROF_PLAN_BUFFER);
+     ...
+   }
+   prof_report(stdout);
+ @endcode
+ */
+#ifndef _LAOSPROF_H_
+#define _LAOSPROF_H_
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef PROFILE
+#define PROFILE 0 // 1: compile in the profiling regions
+#endif
+
+#define PROF_BUCKETS 16 // histogram: bucket n counts times below 2^(n+5) ticks, the last one the rest
+
+// Region table: id, name in the report
+#define PROF_TABLE \
+  PR(PROF_STEP_ISR,     "st_interrupt") \
+  PR(PROF_TRAPEZOID,    "trapezoid_generator_reset") \
+  PR(PROF_PLAN_BUFFER,  "plan_buffer_line") \
+  PR(PROF_NET_POLL,     "net poll")
+
+#define PR(id, name) id,
+enum { PROF_TABLE PROF_COUNT };
+#undef PR
+
+#if PROFILE
+
+#ifdef TARGET_LPC1768
+#include "mbed.h"
+#define PROF_TICKS_PER_US (SystemCoreClock / 1000000)
+static inline uint32_t prof_now() { return DWT->CYCCNT; }
+#else
+#include <time.h>
+#define PROF_TICKS_PER_US 1000
+static inline uint32_t prof_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000000000UL + (uint32_t)ts.tv_nsec;
+}
+#endif
+
+void prof_add(int region, uint32_t ticks); // add a measurement
+void prof_reset(); // clear all regions
+void prof_report(FILE *fp); // write the statistics as text
+
+// Measure the lifetime of this object
+class tProfScope {
+public:
+  tProfScope(int region) : region(region), start(prof_now()) {}
+  ~tProfScope() { prof_add(region, prof_now() - start); }
+private:
+  int region;
+  uint32_t start;
+};
+
+#define PROF_SCOPE(region) tProfScope prof_scope_##region(region)
+
+#else
+
+#define PROF_SCOPE(region)
+static inline void prof_reset() {}
+static inline void prof_report(FILE *fp) {}
+
+#endif
+
+#endif
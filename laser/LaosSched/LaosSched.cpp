@@ -0,0 +1,115 @@
+/**
+ * LaosSched.cpp
+ * Cooperative (run to completion) task scheduler
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include "LaosSched.h"
+
+static tTask tasks[SCHED_MAX_TASKS];
+static int ntasks = 0;
+static tClockFn now = NULL;
+static tTask *running = NULL; // task that is running (NULL: not in a task)
+static uint32_t deadline;     // end of the budget of the running task [usec]
+
+/**
+*** Set the clock and remove all tasks
+**/
+void sched_init(tClockFn clock)
+{
+  now = clock;
+  ntasks = 0;
+  running = NULL;
+}
+
+/**
+*** Add a task, returns the task id or -1 if there is no room
+**/
+int sched_add(const char *name, tTaskFn fn, uint32_t period, uint32_t budget, int flags)
+{
+  if ( ntasks >= SCHED_MAX_TASKS )
+    return -1;
+  tTask *t = &tasks[ntasks];
+  t->name = name;
+  t->fn = fn;
+  t->period = period;
+  t->budget = budget;
+  t->flags = flags;
+  t->last = now();
+  t->runs = t->overruns = t->maxtime = 0;
+  return ntasks++;
+}
+
+/**
+*** Run all tasks that are due. Called from a task (a wait loop), only the
+*** background tasks are run and the calling task is never re-entered.
+**/
+void sched_run()
+{
+  tTask *caller = running;
+  uint32_t caller_deadline = deadline;
+  for (int i=0; i<ntasks; i++)
+  {
+    tTask *t = &tasks[i];
+    if ( t == caller || (caller != NULL && !(t->flags & SCHED_BACKGROUND)) )
+      continue;
+    uint32_t start = now();
+    if ( t->period && (uint32_t)(start - t->last) < t->period )
+      continue;
+    t->last = start;
+    running = t;
+    deadline = start + t->budget;
+    t->fn();
+    uint32_t time = now() - start;
+    t->runs++;
+    if ( time > t->maxtime ) t->maxtime = time;
+    if ( time > t->budget ) t->overruns++;
+  }
+  running = caller;
+  deadline = caller_deadline;
+}
+
+/**
+*** True if the running task has used its time budget
+**/
+int sched_expired()
+{
+  return running != NULL && (int32_t)(now() - deadline) >= 0;
+}
+
+/**
+*** Task info and statistics
+**/
+const tTask *sched_task(int id)
+{
+  if ( id < 0 || id >= ntasks )
+    return NULL;
+  return &tasks[id];
+}
+
+/**
+*** Print the task statistics
+**/
+void sched_report()
+{
+  for (int i=0; i<ntasks; i++)
+    printf("%-8s runs: %lu, max: %lu usec, over budget: %lu\r\n", tasks[i].name,
+      (unsigned long)tasks[i].runs, (unsigned long)tasks[i].maxtime, (unsigned long)tasks[i].overruns);
+}
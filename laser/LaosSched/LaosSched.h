@@ -0,0 +1,67 @@
+/**
+ * LaosSched.h
+ * Cooperative (run to completion) task scheduler
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Tasks are plain functions, called from sched_run() when their period has passed.
+ * A task runs to completion; long running tasks check sched_expired() to give
+ * the other tasks a turn when their time budget is used up.
+ * Code that has to wait (for the motion queue, a file transfer, etc) calls sched_run()
+ * in its wait loop. While waiting inside a task, only the SCHED_BACKGROUND tasks
+ * (network, watchdog) are run, so the waiting task is never re-entered.
+ * The scheduler only uses the clock function passed to sched_init(), it does not depend
+ * on mbed and can be run on a host with a fake clock.
+ *
+ @code
+   sched_init(&clock_us);
+   sched_add("net", &net_poll, 0, 2000, SCHED_BACKGROUND);
+   sched_add("menu", &menu_handle, 0, 10000, 0);
+   while (1) sched_run();
+ @endcode
+ */
+#ifndef _LAOSSCHED_H_
+#define _LAOSSCHED_H_
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS 8
+#define SCHED_BACKGROUND 1 // task also runs while another task waits
+
+typedef void (*tTaskFn)(void);
+typedef uint32_t (*tClockFn)(void); // free running clock [usec]
+
+typedef struct {
+  const char *name;
+  tTaskFn fn;
+  uint32_t period;   // minimal time between runs [usec], 0: every sched_run()
+  uint32_t budget;   // time budget per run [usec]
+  int flags;
+  uint32_t last;     // start of the last run [usec]
+  uint32_t runs;     // nr of runs
+  uint32_t overruns; // nr of runs longer than the budget
+  uint32_t maxtime;  // longest run [usec]
+} tTask;
+
+void sched_init(tClockFn clock); // set the clock and remove all tasks
+int sched_add(const char *name, tTaskFn fn, uint32_t period, uint32_t budget, int flags); // returns the task id, or -1
+void sched_run(); // run all tasks that are due, once
+int sched_expired(); // the time budget of the running task is used up
+const tTask *sched_task(int id); // task info and statistics (NULL if id is invalid)
+void sched_report(); // print the task statistics
+
+#endif
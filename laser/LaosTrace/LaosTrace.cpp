@@ -0,0 +1,99 @@
+/**
+ * LaosTrace.cpp
+ * Binary event trace in a RAM ring buffer
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "mbed.h"
+#include "LaosTrace.h"
+
+static tTraceEvent events[TRACE_EVENTS];
+static volatile uint32_t head = 0, tail = 0; // free running indexes
+static uint32_t lost = 0;   // events lost because the buffer was full
+static tClockFn now = NULL; // NULL: trace is off
+static int trace_mode = 0;
+static FILE *trace_file = NULL;
+
+/**
+*** Start tracing, mode: 0 = off, 1 = serial, 2 = SD
+**/
+void trace_init(tClockFn clock, int mode)
+{
+  trace_mode = mode;
+  now = (mode ? clock : NULL);
+}
+
+/**
+*** Add an event to the ring buffer (drops it when the buffer is full)
+**/
+void trace_event(int id, int32_t a, int32_t b, int32_t c)
+{
+  tTraceEvent *e;
+  if ( now == NULL )
+    return;
+  __disable_irq();
+  if ( head - tail >= TRACE_EVENTS )
+  {
+    lost++;
+    __enable_irq();
+    return;
+  }
+  e = &events[head % TRACE_EVENTS];
+  head++;
+  __enable_irq();
+  e->sync = TRACE_SYNC;
+  e->id = id;
+  e->time = now();
+  e->arg[0] = a;
+  e->arg[1] = b;
+  e->arg[2] = c;
+}
+
+/**
+*** Write the events, until the budget of the task is used up
+**/
+void trace_drain()
+{
+  FILE *fp = stdout;
+  if ( now == NULL || head == tail )
+    return;
+  if ( trace_mode == 2 )
+  {
+    if ( trace_file == NULL )
+      trace_file = fopen("/sd/trace.bin", "ab");
+    if ( trace_file == NULL )
+      return;
+    fp = trace_file;
+  }
+  while ( head != tail && !sched_expired() )
+  {
+    fwrite(&events[tail % TRACE_EVENTS], sizeof(tTraceEvent), 1, fp);
+    tail++;
+    if ( fp != stdout && (tail % 64) == 0 ) // make sure the file is on SD once in a while
+      fflush(fp);
+  }
+  if ( lost && head - tail < TRACE_EVENTS )
+  {
+    int n = lost;
+    lost = 0;
+    trace_event(EV_LOST, n, 0, 0);
+  }
+  if ( fp == stdout )
+    fflush(fp);
+}
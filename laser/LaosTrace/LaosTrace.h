@@ -0,0 +1,74 @@
+/**
+ * LaosTrace.h
+ * Binary event trace in a RAM ring buffer
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * TRACE() stores an event (id, 3 integer arguments and a time stamp) in a ring buffer,
+ * this is cheap enough for the step interrupt and the job parser. The "trace" task
+ * sends the events to the serial port or to a file on SD (sys.trace), in the background.
+ * Events above TRACE_LEVEL are not compiled in.
+ * The dump is decoded with tools/tracedecode.py, which reads the event table below.
+ *
+ @code
+   TRACE(TRACE_INFO, EV_SET_POSITION, x, y, z);
+ @endcode
+ */
+#ifndef _LAOSTRACE_H_
+#define _LAOSTRACE_H_
+#include <stdint.h>
+#include "LaosSched.h"
+
+#define TRACE_ERROR 1
+#define TRACE_INFO  2
+#define TRACE_DEBUG 3
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_INFO // events with a higher level are left out at compile time
+#endif
+
+#define TRACE_EVENTS 128 // size of the ring buffer [events]
+#define TRACE_SYNC 0xA55A // start of each event in the dump
+
+// Event table: id, format of the arguments (for the decoder)
+#define TRACE_TABLE \
+  EV(EV_NONE,          "") \
+  EV(EV_LOST,          "%d events lost") \
+  EV(EV_TARGET,        "target x: ofs=%d um, i=%d um, x=%d um") \
+  EV(EV_POWER,         "power: %d") \
+  EV(EV_SET_POSITION,  "set position: %d,%d,%d steps") \
+  EV(EV_HOME,          "home: %d,%d,%d um") \
+  EV(EV_HOME_DONE,     "home done")
+
+#define EV(id, fmt) id,
+enum { TRACE_TABLE EV_COUNT };
+#undef EV
+
+typedef struct {
+  uint16_t sync;  // TRACE_SYNC
+  uint16_t id;
+  uint32_t time;  // [usec]
+  int32_t arg[3];
+} tTraceEvent;
+
+#define TRACE(level, id, a, b, c) do { if ( (level) <= TRACE_LEVEL ) trace_event(id, a, b, c); } while (0)
+
+void trace_init(tClockFn clock, int mode); // mode: 0 = off, 1 = serial, 2 = SD (/sd/trace.bin)
+void trace_event(int id, int32_t a, int32_t b, int32_t c); // add an event (also from interrupts)
+void trace_drain(); // scheduler task: write the events
+
+#endif
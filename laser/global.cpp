@@ -54,7 +54,7 @@ void IpParse(char *a, int i[])
 *** Global config
 *** Config settings into global Config struct
 **/
-GlobalConfig::GlobalConfig(char *filename)
+GlobalConfig::GlobalConfig(const char *filename)
 {
    char val[32];
    printf("\r\nOpen config file: '%s'\r\n", filename);
@@ -82,6 +82,9 @@ GlobalConfig::GlobalConfig(char *filename)
     cfg.Value("sys.nodisplay", &nodisplay, 1);
     cfg.Value("sys.i2cbaud", &i2cbaud, 9600);
     cfg.Value("sys.cleandir", &cleandir, 1);
+    cfg.Value("sys.checkpoint", &checkpoint, 0); // job checkpoint interval [sec], 0: off
+    cfg.Value("sys.watchdog", &watchdog, 0); // watchdog timeout [sec], 0: off
+    cfg.Value("sys.trace", &trace, 0); // binary event trace: 0: off, 1: serial, 2: SD (trace.bin)
 
     // Laser
     cfg.Value("laser.enable", &lenable, 1); // laser enable polarity [0/1]
@@ -89,6 +92,11 @@ GlobalConfig::GlobalConfig(char *filename)
     cfg.Value("laser.pwm.min", &pwmmin, 0); // pwm at minimum power [0..100]
     cfg.Value("laser.pwm.max", &pwmmax, 0); // pwm at maximum power [0..100]
     cfg.Value("laser.pwm.freq", &pwmfreq, 20000); // pwm frequency [Hz]
+    cfg.Value("laser.pulse", &pulse, 100); // default pulse length in ppi mode [usec]
+    cfg.Value("laser.scale.min", &scalemin, 100); // minimal power when scaled with speed [0..100]
+    cfg.Value("laser.pixelclock", &pixelclock, 0); // time based pixel clock for bitmap lines [0/1]
+    cfg.Value("laser.shift.pos", &shiftpos, 0); // raster pixel shift, lines in +X direction [usec]
+    cfg.Value("laser.shift.neg", &shiftneg, 0); // raster pixel shift, lines in -X direction [usec]
 
     // rest position (after homing)
     cfg.Value("x.rest", &xrest, 0);
@@ -128,6 +136,12 @@ GlobalConfig::GlobalConfig(char *filename)
     cfg.Value("z.speed", &zspeed, 100);
     cfg.Value("e.speed", &espeed, 100);
 
+    // max axis acceleration [mm/sec2], 0: only limited by motion.accel
+    cfg.Value("x.accel", &xaccel, 0);
+    cfg.Value("y.accel", &yaccel, 0);
+    cfg.Value("z.accel", &zaccel, 0);
+    cfg.Value("e.accel", &eaccel, 0);
+
     // home positions [um]
     cfg.Value("x.home", &xhome, 0);
     cfg.Value("y.home", &yhome, 0);
@@ -146,10 +160,19 @@ GlobalConfig::GlobalConfig(char *filename)
 
     // motion settings: enable output state
     cfg.Value("motion.homespeed", &homespeed, 10); // speed during homing [usec/step / 2]
+    cfg.Value("motion.homefast", &homefast, 100); // accelerated approach of the home switches [mm/sec]
+    cfg.Value("motion.homeback", &homeback, 2000); // back-off before the slow approach [micron]
     cfg.Value("motion.manualspeed", &manualspeed, 10); // speed during manual movement [usec/step / 2]
     cfg.Value("motion.speed", &speed, 100);   // max speed [mm/sec]
     cfg.Value("motion.accel", &accel, 100); // accelleration [mm/sec2]
+    cfg.Value("motion.jerk", &jerk, 0); // jerk limit [mm/sec3], 0: no S-curve
+    cfg.Value("motion.rapid.speed", &rapidspeed, 0); // travel move speed [mm/sec], 0: motion.speed
+    cfg.Value("motion.rapid.accel", &rapidaccel, 0); // travel move acceleration [mm/sec2], 0: motion.accel
+    if ( rapidspeed <= 0 ) rapidspeed = speed;
     cfg.Value("motion.enable", &enable, 0); // enable output polarity [0/1]
     cfg.Value("motion.tolerance", &tolerance, 50); // cornering tolerance [1/1000 units]
+    cfg.Value("motion.merge", &merge, 0); // merge collinear segments within this deviation [micron], 0: off
+    cfg.Value("motion.curve", &curve, 10); // chord error of arcs and curves [micron]
+    cfg.Value("motion.blend", &blend, 0); // round corners within this deviation [micron], 0: off
 }
 
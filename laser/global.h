@@ -41,6 +41,9 @@ public:
   int autozhome; // automatically home the zaxis as well
   int nodisplay; // there is no display
   int cleandir; // remove files from SD at startup
+  int checkpoint; // interval for job checkpoints on SD [sec], 0 = off
+  int watchdog; // watchdog timeout [sec], 0 = off
+  int trace; // event trace: 0 = off, 1 = serial, 2 = SD
   int i2cbaud; // i2cBaudrate
   int xmax, ymax, zmax, emax; // max values
   int xhasendstop,yhasendstop; // x/y has endstop
@@ -51,16 +54,27 @@ public:
   int xrest, yrest, zrest, erest; // rest positon (moveto after job)
   int xhomedir, yhomedir, zhomedir, ehomedir;
   int homespeed; // speed used for homing [usec/step / 2]
+  int homefast, homeback; // homing: fast approach speed [mm/sec] and back-off distance [micron]
   int manualspeed; // speed used for homing [usec/step / 2]
   int speed, xspeed, yspeed, zspeed, espeed; // Maximum linear speed and max speed per axis [mm/sec]
   int accel; // defaul accelletaion [mm/sec2]
+  int xaccel, yaccel, zaccel, eaccel; // Maximum acceleration per axis [mm/sec2], 0 = use accel
+  int jerk; // jerk limit for S-curve acceleration [mm/sec3], 0 = constant acceleration
+  int rapidspeed, rapidaccel; // speed [mm/sec] and acceleration [mm/sec2] of travel moves (laser off)
   int tolerance; // corner tolerance [micrometer]
+  int merge; // max path deviation when merging short collinear segments [micrometer], 0 = off
+  int curve; // max chord error when arcs and curves are split in lines [micrometer]
+  int blend; // max path deviation when corners are rounded [micrometer], 0 = off
   int xscale; // steps per meter
   int yscale; // steps per meter
   int zscale; // steps per meter
   int escale; // steps per meter
   int lenable, lon, pwmmin, pwmmax, pwmfreq; // laser enable, laser on and pwm min/max [%] and frequency [Hz];
-  GlobalConfig(char *filename);
+  int pulse; // default pulse length in ppi mode [usec]
+  int scalemin; // minimal laser power at low speed [% of the power at nominal speed], 100 disables scaling
+  int pixelclock; // switch bitmap pixels on time instead of on step events (at constant speed)
+  int shiftpos, shiftneg; // raster pixel shift (laser delay) for lines in +X and -X direction [usec]
+  GlobalConfig(const char *filename);
 };
 extern GlobalConfig *cfg;
 
@@ -48,6 +48,10 @@
 #include "LaosMotion.h"
 #include "SDFileSystem.h"
 #include "laosfilesystem.h"
+#include "LaosSched.h"
+#include "LaosTrace.h"
+#include "LaosProf.h"
+#include "LaosJobLog.h"
 
 // MBED blue status leds
 DigitalOut led1(LED1);
@@ -76,6 +80,12 @@ GlobalConfig *cfg;
 
 // Protos
 void GetFile(void);
+static uint32_t clock_us();
+static void net_poll();
+static void wdt_start(int sec);
+static void wdt_feed();
+static void menu_task();
+static void tftp_task();
 void main_nodisplay();
 void main_menu();
 
@@ -137,6 +147,19 @@ int main()
 
   printf("SERVER...\r\n");
   srv = new TFTPServer("/sd", cfg->port);
+
+  // scheduler: the network and the watchdog also run while other code waits
+  sched_init(&clock_us);
+  sched_add("net", &net_poll, 0, 2000, SCHED_BACKGROUND);
+  if ( cfg->watchdog )
+  {
+    wdt_start(cfg->watchdog);
+    sched_add("wdt", &wdt_feed, 100000, 100, SCHED_BACKGROUND);
+  }
+  trace_init(&clock_us, cfg->trace);
+  if ( cfg->trace )
+    sched_add("trace", &trace_drain, 0, 1000, SCHED_BACKGROUND);
+  sched_add("joblog", &joblog_flush, 1000000, 20000, 0);
   mnu->SetScreen("SERVER OK....");
   wait(0.5);
   mnu->SetScreen(9); // IP
@@ -155,7 +178,7 @@ int main()
   // Start homing
     mnu->SetScreen("WAIT FOR COVER....");
     //if ( cfg->waitforstart )
-      while ( !mot->isStart() );
+      while ( !mot->isStart() ) sched_run();
     mnu->SetScreen("HOME....");
     printf("HOME...\r\n");
 
@@ -168,7 +191,7 @@ int main()
 
   // clean sd card?
   if (cfg->cleandir) cleandir();
-  mnu->SetScreen(NULL);
+  mnu->SetScreen((const char*)NULL);
 
   if (cfg->nodisplay) {
     printf("No display set\r\n");
@@ -177,6 +200,7 @@ int main()
     printf("Entering display\r\n");
     main_menu();
   }
+  return 0;
 }
 
 void main_nodisplay() {
@@ -188,7 +212,7 @@ void main_nodisplay() {
     led1=led2=led3=led4=0;
     mnu->SetScreen("Wait for file ...");
     while (srv->State() == listen)
-        Net::poll();
+        sched_run();
     GetFile();
     mot->reset();
     plan_get_current_position_xyz(&x, &y, &z);
@@ -199,53 +223,107 @@ void main_nodisplay() {
     srv->getFilename(name);
     printf("Now processing file: '%s'\r\n", name);
     FILE *in = sd.openfile(name, "r");
+    jobStart(in);
     while (!feof(in))
     {
-      while (!mot->ready() );
+      if ( !mot->isStart() ) // lid open: pause the job until the lid is closed
+      {
+        mot->hold();
+        mnu->SetScreen("PAUSE: lid open");
+        while ( !mot->isStart() ) sched_run();
+        mnu->SetScreen("Laser BUSY...");
+        mot->resume();
+      }
+      while (!mot->ready() ) sched_run();
       mot->write(readint(in),MODE_RUN);
     }
     fclose(in);
     removefile(name);
     // done
     printf("DONE!...\r\n");
-	while (!mot->ready() );
+    while ( mot->queue() > 0 ) sched_run();
+    jobSummary(name, JOB_DONE);
+    sched_report();
     mot->moveTo(cfg->xrest, cfg->yrest, cfg->zrest);
   }
 }
 
 
 void main_menu() {
+  led1=led2=led3=led4=0;
+  mnu->SetScreen(1);
+  sched_add("menu", &menu_task, 0, 10000, 0);
+  sched_add("tftp", &tftp_task, 0, 1000, 0);
+
   // main loop
-  while (1) {
-        led1=led2=led3=led4=0;
-
-        mnu->SetScreen(1);
-        while (1) {;
-            mnu->Handle();
-            Net::poll();
-            if (srv->State() != listen) {
-                GetFile();
-                char myname[32];
-                srv->getFilename(myname);
-                if (isFirmware(myname)) {
-                    installFirmware(myname);
-                    mnu->SetScreen(1);
-                } else {
-                    if (strcmp("config.txt", myname) == 0) {
-                        // it's a config file!
-                        mnu->SetScreen(1);
-                    } else {
-                        if (isLaosFile(myname)) {
-                            mnu->SetFileName(myname);
-                            mnu->SetScreen(2);
-                        }
-                    }
+  while (1)
+    sched_run();
+}
+
+/**
+*** Menu task: keys, display and feeding the running job to the motion controller
+**/
+static void menu_task() {
+    mnu->Handle();
+}
+
+/**
+*** TFTP task: receive a file when a transfer starts
+**/
+static void tftp_task() {
+    if (srv->State() != listen) {
+        GetFile();
+        char myname[32];
+        srv->getFilename(myname);
+        if (isFirmware(myname)) {
+            installFirmware(myname);
+            mnu->SetScreen(1);
+        } else {
+            if (strcmp("config.txt", myname) == 0) {
+                // it's a config file!
+                mnu->SetScreen(1);
+            } else {
+                if (isLaosFile(myname)) {
+                    mnu->SetFileName(myname);
+                    mnu->SetScreen(2);
                 }
             }
         }
     }
 }
 
+/**
+*** Scheduler clock [usec]
+**/
+static uint32_t clock_us() {
+    return systime.read_us();
+}
+
+/**
+*** Network task (profiled)
+**/
+static void net_poll() {
+    PROF_SCOPE(PROF_NET_POLL);
+    Net::poll();
+}
+
+/**
+*** Watchdog: reset when it is not fed for sec seconds (WDT clock: PCLK/4 = CCLK/16)
+**/
+static void wdt_start(int sec) {
+    LPC_WDT->WDCLKSEL = 0x1; // PCLK
+    LPC_WDT->WDTC = sec * (SystemCoreClock / 16);
+    LPC_WDT->WDMOD = 0x3; // enable, reset on timeout
+    wdt_feed();
+}
+
+static void wdt_feed() {
+    __disable_irq();
+    LPC_WDT->WDFEED = 0xAA;
+    LPC_WDT->WDFEED = 0x55;
+    __enable_irq();
+}
+
 /**
 *** Get file from network and save on SDcard
 *** Ascii data is read from the network, and saved on the SD card in binary int32 format
@@ -256,7 +334,7 @@ void GetFile(void) {
    mnu->SetScreen("Receive file...");
    t.start();
    while (srv->State() != listen) {
-     Net::poll();
+     sched_run();
      switch ((int)t.read()) {
         case 1:
             mnu->SetScreen("Receive file");
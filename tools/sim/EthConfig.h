@@ -0,0 +1,21 @@
+/**
+ * EthConfig.h
+ * Host stand-in: no network interface, Net::poll() lets the simulated time pass (see sim_net.cpp)
+ */
+#ifndef _SIM_ETHCONFIG_H_
+#define _SIM_ETHCONFIG_H_
+#include "global.h"
+
+class EthernetNetIf {
+};
+
+class Net {
+public:
+  static void poll();
+};
+
+EthernetNetIf * EthConfig();
+bool EthSpeed(void);
+bool EthLink(void);
+
+#endif
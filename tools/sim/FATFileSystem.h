@@ -0,0 +1,9 @@
+/**
+ * FATFileSystem.h
+ * Host stand-in: files are opened with the host C library
+ */
+#ifndef _SIM_FATFILESYSTEM_H_
+#define _SIM_FATFILESYSTEM_H_
+#include <dirent.h>
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * SDFileSystem.h
+ * Host stand-in: the SD card is a directory on the host (see sim_mbed.cpp)
+ */
+#ifndef _SIM_SDFILESYSTEM_H_
+#define _SIM_SDFILESYSTEM_H_
+#include "mbed.h"
+
+class SDFileSystem {
+public:
+  SDFileSystem(PinName mosi, PinName miso, PinName sclk, PinName cs, const char *name) {}
+  virtual ~SDFileSystem() {}
+};
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * TFTPServer.h
+ * Host stand-in: files "arrive" when a test queues them with sim_tftp_put() (see sim_net.cpp)
+ */
+#ifndef _SIM_TFTPSERVER_H_
+#define _SIM_TFTPSERVER_H_
+#include "mbed.h"
+
+enum TFTPServerState { listen, reading, writing, suspended, deleted }; // no error state, error() is a function here
+
+class TFTPServer {
+public:
+  TFTPServer(const char* dir, int myport = 69) {}
+  TFTPServerState State();
+  void getFilename(char* name);
+};
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * check.h
+ * Minimal checks for the host tests: report the failed condition, count the failures
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ @code
+   CHECK(mot->queue() == 0);
+   CHECK_NEAR(x, 10000, 5);
+   return check_done();
+ @endcode
+ */
+#ifndef _CHECK_H_
+#define _CHECK_H_
+#include <stdio.h>
+#include <math.h>
+
+static int check_failed = 0;
+
+#define CHECK(cond) do { if ( !(cond) ) { check_failed++; \
+  printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while (0)
+
+#define CHECK_NEAR(a, b, tol) do { double a_ = (a), b_ = (b); if ( fabs(a_ - b_) > (tol) ) { check_failed++; \
+  printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g, %g\n", __FILE__, __LINE__, #a, #b, a_, b_); } } while (0)
+
+// exit code of the test
+static inline int check_done()
+{
+  if ( check_failed )
+    printf("%d checks failed\n", check_failed);
+  return check_failed ? 1 : 0;
+}
+
+#endif
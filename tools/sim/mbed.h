@@ -0,0 +1,172 @@
+/**
+ * mbed.h
+ * Host (Linux) stand-in for the parts of the mbed library used by the laser firmware
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * All time is simulated: Ticker and Timeout callbacks ("interrupts") are fired by
+ * sim_step() in time order, Timer and wait() use the same clock.
+ * The registers the firmware writes directly are plain memory.
+ */
+#ifndef _SIM_MBED_H_
+#define _SIM_MBED_H_
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Simulated clock
+extern uint64_t sim_now; // [usec]
+int sim_step(); // fire the next timer event, returns 0 if there is none
+void sim_run_until(uint64_t t); // fire all events up to time t [usec]
+extern void (*sim_event_hook)(); // called after each timer event
+
+typedef int PinName;
+enum {
+  p5=5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15, p16, p17, p18, p19, p20,
+  p21, p22, p23, p24, p25, p26, p27, p28, p29, p30,
+  LED1, LED2, LED3, LED4, USBTX, USBRX
+};
+enum PinMode { PullUp, PullDown, PullNone };
+
+class DigitalOut {
+public:
+  DigitalOut(PinName pin) : pin(pin), value(0) {}
+  void write(int v) { value = v; }
+  int read() { return value; }
+  DigitalOut& operator= (int v) { value = v; return *this; }
+  DigitalOut& operator= (DigitalOut &rhs) { value = rhs.value; return *this; }
+  operator int() { return value; }
+  PinName pin;
+  int value;
+};
+
+class DigitalIn {
+public:
+  DigitalIn(PinName pin) : pin(pin), value(1) {} // inputs are pulled up (cover closed, switches open)
+  void mode(PinMode m) {}
+  int read() { return value; }
+  operator int() { return value; }
+  PinName pin;
+  int value;
+};
+
+// PWM on PWM1.5 (the laser output): the period and duty are kept in the LPC_PWM1 registers,
+// like the firmware reads and writes them
+class PwmOut {
+public:
+  PwmOut(PinName pin) {}
+  void period(float s) { period_us((int)(s * 1e6 + 0.5)); }
+  void period_us(int us);
+  void pulsewidth_us(int us);
+  void write(float v);
+  float read();
+  PwmOut& operator= (float v) { write(v); return *this; }
+  operator float() { return read(); }
+};
+
+class Ticker {
+public:
+  Ticker() : fn(NULL), next(0), period(0), oneshot(0) {}
+  ~Ticker() { detach(); }
+  void attach(void (*f)(void), float s) { attach_us(f, (unsigned int)(s * 1e6)); }
+  void attach_us(void (*f)(void), unsigned int us);
+  void detach();
+  void (*fn)(void);
+  uint64_t next;   // time of the next call [usec]
+  uint32_t period; // [usec]
+  int oneshot;
+};
+
+class Timeout : public Ticker {
+public:
+  Timeout() { oneshot = 1; }
+};
+
+class Timer {
+public:
+  Timer() : running(0), t0(0), total(0) {}
+  void start() { if ( !running ) { t0 = sim_now; running = 1; } }
+  void stop() { if ( running ) { total += sim_now - t0; running = 0; } }
+  void reset() { total = 0; t0 = sim_now; }
+  int read_us() { return (int)(total + (running ? sim_now - t0 : 0)); }
+  int read_ms() { return (int)((total + (running ? sim_now - t0 : 0)) / 1000); }
+  float read() { return (total + (running ? sim_now - t0 : 0)) / 1e6; }
+private:
+  int running;
+  uint64_t t0, total;
+};
+
+// No display is attached: reads fail, so LaosDisplay runs in its serial simulation mode
+class I2C {
+public:
+  I2C(PinName sda, PinName scl) {}
+  void frequency(int hz) {}
+  int read(int address, char *data, int length, bool repeated = false) { return 1; }
+  int write(int address, const char *data, int length, bool repeated = false) { return 1; }
+};
+
+class Serial {
+public:
+  Serial(PinName tx, PinName rx) {}
+  void baud(int b) {}
+  int readable() { return 0; }
+  int getc() { return getchar(); }
+  int putc(int c) { return putchar(c); }
+  int printf(const char *fmt, ...);
+};
+
+// The local flash drive: "/local/" is the SD directory as well (see sim_mbed.cpp)
+class LocalFileSystem {
+public:
+  LocalFileSystem(const char *name) {}
+};
+
+void wait(float s);
+void wait_ms(int ms);
+void wait_us(int us);
+void error(const char *fmt, ...);
+extern "C" void mbed_reset();
+
+#define __disable_irq() do {} while (0) // events never preempt the main code
+#define __enable_irq() do {} while (0)
+
+// Registers
+typedef struct { volatile uint32_t IR, TCR, TC, PR, PC, MCR, MR0, MR1, MR2, MR3, CCR, CR0, CR1, CR2, CR3,
+  RESERVED0, MR4, MR5, MR6, PCR, LER, RESERVED1[7], CTCR; } LPC_PWM_TypeDef;
+typedef struct { volatile uint32_t I2CONSET, I2STAT, I2DAT, I2ADR0, I2SCLH, I2SCLL, I2CONCLR; } LPC_I2C_TypeDef;
+typedef struct { volatile uint32_t WDMOD, WDTC, WDFEED, WDTV, WDCLKSEL; } LPC_WDT_TypeDef;
+typedef struct { volatile uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+extern LPC_PWM_TypeDef *LPC_PWM1;
+extern LPC_I2C_TypeDef *LPC_I2C1;
+extern LPC_WDT_TypeDef *LPC_WDT; // the watchdog never fires
+extern CoreDebug_Type *CoreDebug;
+extern DWT_Type *DWT; // CYCCNT does not count: use PROFILE=1 for host timing
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+extern uint32_t SystemCoreClock;
+
+typedef enum { I2C1_IRQn = 11 } IRQn_Type;
+static inline void NVIC_SetVector(IRQn_Type irq, uint32_t vector) {}
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {}
+static inline void NVIC_EnableIRQ(IRQn_Type irq) {}
+static inline void NVIC_DisableIRQ(IRQn_Type irq) {}
+
+#endif
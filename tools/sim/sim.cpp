@@ -0,0 +1,147 @@
+/**
+ * sim.cpp
+ * Run a job through the laser firmware on a host (Linux), with a simulated clock
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The job is fed to LaosMotion like main_nodisplay() does. The step interrupt runs on
+ * the simulated clock, so the job time is the time the machine would need; the host
+ * time is the cost of the parser, planner and step interrupt.
+ * The step trace has one line per change: time [usec], x, y, z [steps], laser [0/1].
+ * The profile has one line per sample interval: time [sec], x, y, z [mm], speed [mm/sec],
+ * acceleration [mm/sec2] and laser [0/1], for plots of the ramps (trapezoid or S-curve, motion.jerk).
+ * Speed and acceleration are differences of the sampled positions: the step resolution
+ * makes the acceleration noisy at short intervals, use 10 msec or more.
+ *
+ * usage: laos-sim [-d sd-directory] [-t steptrace.txt] [-p profile.txt] [-i interval] job.lgc
+ *   config.txt is read from the sd-directory (default: .)
+ *   interval: profile sample interval [usec] (default: 10000)
+ */
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+#include "pins.h"
+#include "laosfilesystem.h"
+#include "LaosSched.h"
+#include "LaosTrace.h"
+#include "LaosProf.h"
+
+static FILE *steptrace = NULL;
+static FILE *profile = NULL;
+
+// after each interrupt: write the position and laser state when they changed
+static void sim_trace()
+{
+  static int32_t x, y, z;
+  static int l = -1;
+  int on = (laser != NULL && laser->read() == LASERON);
+  if ( actpos_x == x && actpos_y == y && actpos_z == z && on == l )
+    return;
+  x = actpos_x;
+  y = actpos_y;
+  z = actpos_z;
+  l = on;
+  fprintf(steptrace, "%llu %d %d %d %d\n", (unsigned long long)sim_now, (int)x, (int)y, (int)z, l);
+}
+
+// every sample interval: write the position, speed and acceleration
+static void sim_profile(const tSimSample *s)
+{
+  static tSimSample prev;
+  static double v = 0;
+  static int n = 0;
+  double a = 0, vnew = 0;
+  if ( n++ > 0 )
+  {
+    double dt = s->t - prev.t;
+    vnew = sqrt((s->x-prev.x)*(s->x-prev.x) + (s->y-prev.y)*(s->y-prev.y) + (s->z-prev.z)*(s->z-prev.z)) / dt;
+    a = (vnew - v) / dt;
+  }
+  v = vnew;
+  prev = *s;
+  fprintf(profile, "%.4f %.3f %.3f %.3f %.2f %.0f %d\n", s->t, s->x, s->y, s->z, v, a, s->laser);
+}
+
+static double host_time()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+  int opt;
+  const char *sd_dir = ".";
+  uint32_t interval = 10000;
+  double t0, t1;
+  FILE *in;
+
+  while ( (opt = getopt(argc, argv, "d:t:p:i:")) != -1 )
+  {
+    switch ( opt )
+    {
+      case 'd': sd_dir = optarg; break;
+      case 't':
+        steptrace = fopen(optarg, "w");
+        if ( steptrace == NULL ) { perror(optarg); return 1; }
+        break;
+      case 'p':
+        profile = fopen(optarg, "w");
+        if ( profile == NULL ) { perror(optarg); return 1; }
+        break;
+      case 'i': interval = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-d sd-directory] [-t steptrace.txt] [-p profile.txt] [-i interval] job.lgc\n", argv[0]);
+        return 1;
+    }
+  }
+  if ( optind >= argc )
+  {
+    fprintf(stderr, "usage: %s [-d sd-directory] [-t steptrace.txt] [-p profile.txt] [-i interval] job.lgc\n", argv[0]);
+    return 1;
+  }
+  in = fopen(argv[optind], "rb");
+  if ( in == NULL ) { perror(argv[optind]); return 1; }
+
+  sim_config(sd_dir);
+  sim_start();
+  if ( steptrace )
+    sim_event_hook = &sim_trace;
+  if ( profile )
+    sim_sample(interval, &sim_profile);
+
+  uint64_t start = sim_now;
+  t0 = host_time();
+  while ( !feof(in) )
+    sim_write(readint(in));
+  fclose(in);
+  sim_finish();
+  t1 = host_time();
+
+  printf("job time: %.3f sec\r\n", (sim_now - start) / 1e6);
+  printf("host time: %.3f sec\r\n", t1 - t0);
+  mot->printStats(stdout);
+  prof_report(stdout);
+  trace_drain();
+  if ( steptrace )
+    fclose(steptrace);
+  if ( profile )
+    fclose(profile);
+  return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * sim.h
+ * Run the laser firmware on a host (Linux): firmware globals and job feeding,
+ * shared by laos-sim and the tests. The full firmware (laos-fw, test_fw_*) runs main.cpp
+ * instead, jobs arrive by (simulated) TFTP.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * A test reads the config (or takes the defaults), changes cfg where needed,
+ * then starts the motion and feeds the job words:
+ *
+ @code
+   sim_config(NULL);
+   cfg->blend = 0;
+   sim_start();
+   sim_write(1); sim_write(10000); sim_write(0); // line to x=10mm
+   sim_finish();
+ @endcode
+ *
+ * The full firmware owns the globals and the scheduler, a test queues the files and
+ * checks the result when the firmware waits for the next file:
+ *
+ @code
+   sim_sd_dir = dir;
+   sim_tftp_put("job.lgc", "1 10000 0\n");
+   sim_tftp_idle = &done; // checks, exit(check_done())
+   laos_main();
+ @endcode
+ */
+#ifndef _SIM_H_
+#define _SIM_H_
+#include "global.h"
+
+extern LaosMotion *mot;
+extern GlobalConfig *cfg;
+extern LaosDisplay *dsp; // NULL unless a test creates it (homing and jogging read the keys)
+extern const char *sim_sd_dir;
+extern volatile int32_t actpos_x, actpos_y, actpos_z; // stepper position [steps]
+
+void sim_config(const char *sddir); // read config.txt from sddir, NULL: an empty directory (defaults)
+void sim_start(); // create the motion controller and start the scheduler
+void sim_write(int word); // feed one job word, waits until the motion accepts it
+void sim_finish(); // wait until the queue is empty and the machine stopped
+uint32_t sim_clock(); // simulated clock [usec]
+
+// Position sample [mm] at a fixed interval of simulated time (speed and acceleration profiles)
+typedef struct { double t, x, y, z; int laser; } tSimSample; // t [sec]
+void sim_sample(uint32_t period, void (*fn)(const tSimSample *s)); // call fn every period [usec], 0: stop
+
+// Full firmware: main.cpp (built as laos_main) with stand-ins for the network, see sim_net.cpp
+int laos_main(); // never returns, a test ends in sim_tftp_idle()
+void sim_tftp_put(const char *name, const char *text); // queue a file transfer to the SD card
+extern void (*sim_tftp_idle)(); // called while the firmware waits for a file and none is queued
+
+#endif
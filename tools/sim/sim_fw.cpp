@@ -0,0 +1,95 @@
+/**
+ * sim_fw.cpp
+ * Run the full laser firmware (main.cpp, LaosMenu) on a host (Linux)
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The firmware boots from a scratch SD directory with a copy of the config, the jobs
+ * arrive by TFTP in the order given. It stops when it waits for the next job.
+ * The SD directory is kept, it has the job log.
+ *
+ * usage: laos-fw [-c config.txt] job.lgc...
+ */
+#include <unistd.h>
+#include "sim.h"
+
+// the firmware waits for the next file: wait for the motion to stop, then end
+static void sim_done()
+{
+  while ( mot->queue() > 0 )
+    sim_step();
+  printf("sim: %.3f sec, SD directory %s\r\n", sim_now / 1e6, sim_sd_dir);
+  exit(0);
+}
+
+// read a host file, NULL if it cannot be read
+static char *readfile(const char *name)
+{
+  FILE *fp = fopen(name, "rb");
+  long size;
+  char *text;
+  if ( fp == NULL )
+    return NULL;
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  text = (char*)malloc(size + 1);
+  if ( fread(text, 1, size, fp) != (size_t)size )
+    size = 0;
+  text[size] = 0;
+  fclose(fp);
+  return text;
+}
+
+int main(int argc, char **argv)
+{
+  int opt;
+  const char *config = NULL;
+  static char dir[] = "/tmp/laos-fw-XXXXXX";
+
+  while ( (opt = getopt(argc, argv, "c:")) != -1 )
+  {
+    switch ( opt )
+    {
+      case 'c': config = optarg; break;
+      default:
+        fprintf(stderr, "usage: %s [-c config.txt] job.lgc...\n", argv[0]);
+        return 1;
+    }
+  }
+  if ( mkdtemp(dir) == NULL ) { perror(dir); return 1; }
+  sim_sd_dir = dir;
+  if ( config )
+  {
+    char *text = readfile(config);
+    if ( text == NULL ) { perror(config); return 1; }
+    FILE *fp = fopen("/sd/config.txt", "w");
+    fputs(text, fp);
+    fclose(fp);
+    free(text);
+  }
+  for (int i=optind; i<argc; i++)
+  {
+    const char *name = strrchr(argv[i], '/');
+    char *text = readfile(argv[i]);
+    if ( text == NULL ) { perror(argv[i]); return 1; }
+    sim_tftp_put(name ? name + 1 : argv[i], text);
+  }
+  sim_tftp_idle = &sim_done;
+  return laos_main();
+}
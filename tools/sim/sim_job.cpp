@@ -0,0 +1,118 @@
+/**
+ * sim_job.cpp
+ * Run the laser firmware on a host (Linux): firmware globals and job feeding
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The job is fed to LaosMotion like main_nodisplay() does. The step interrupt runs on
+ * the simulated clock: a wait for the motion lets the simulated time pass.
+ */
+#include <stdlib.h>
+#include "sim.h"
+#include "pins.h"
+#include "laosfilesystem.h"
+#include "LaosSched.h"
+#include "LaosTrace.h"
+
+// firmware globals (main.cpp)
+DigitalOut led1(LED1);
+DigitalOut led2(LED2);
+DigitalOut led3(LED3);
+DigitalOut led4(LED4);
+LaosFileSystem sd(p11, p12, p13, p14, "sd");
+LaosDisplay *dsp;
+LaosMotion *mot;
+GlobalConfig *cfg;
+
+uint32_t sim_clock()
+{
+  return (uint32_t)sim_now;
+}
+
+// background task: time passes while the firmware waits
+static void sim_task()
+{
+  if ( !sim_step() )
+    sim_now += 1000; // nothing scheduled: idle
+}
+
+// sampling: a Ticker on the simulated clock, so the samples are taken between the step interrupts
+static Ticker sample_ticker;
+static void (*sample_fn)(const tSimSample *s);
+
+static void sample_tick()
+{
+  tSimSample s;
+  s.t = sim_now / 1e6;
+  s.x = actpos_x / fabs(cfg->xscale / 1000.0);
+  s.y = actpos_y / fabs(cfg->yscale / 1000.0);
+  s.z = actpos_z / fabs(cfg->zscale / 1000.0);
+  s.laser = (laser != NULL && laser->read() == LASERON);
+  sample_fn(&s);
+}
+
+void sim_sample(uint32_t period, void (*fn)(const tSimSample *s))
+{
+  sample_fn = fn;
+  if ( period && fn )
+    sample_ticker.attach_us(&sample_tick, period);
+  else
+    sample_ticker.detach();
+}
+
+/**
+*** Read the config, from an empty scratch directory if sddir is NULL
+**/
+void sim_config(const char *sddir)
+{
+  if ( sddir == NULL )
+  {
+    static char tmp[] = "/tmp/laos-sim-XXXXXX";
+    if ( mkdtemp(tmp) == NULL )
+      error("sim: no scratch directory\n");
+    sddir = tmp;
+  }
+  sim_sd_dir = sddir;
+  cfg = new GlobalConfig("config.txt");
+}
+
+/**
+*** Create the motion controller and start the scheduler (like main())
+**/
+void sim_start()
+{
+  mot = new LaosMotion();
+  sched_init(&sim_clock);
+  sched_add("sim", &sim_task, 0, 0, SCHED_BACKGROUND);
+  trace_init(&sim_clock, cfg->trace);
+  if ( cfg->trace )
+    sched_add("trace", &trace_drain, 0, 1000, SCHED_BACKGROUND);
+  mot->reset();
+  mot->resetStats();
+}
+
+void sim_write(int word)
+{
+  while ( !mot->ready() ) sched_run();
+  mot->write(word, MODE_RUN);
+}
+
+void sim_finish()
+{
+  while ( mot->queue() > 0 ) sched_run();
+}
@@ -0,0 +1,206 @@
+/**
+ * sim_mbed.cpp
+ * Host (Linux) stand-in for the parts of the mbed library used by the laser firmware
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdarg.h>
+#include <dirent.h>
+#include "mbed.h"
+
+#define SIM_EVENTS 16 // max nr of attached tickers
+
+uint64_t sim_now = 0;
+void (*sim_event_hook)() = NULL;
+const char *sim_sd_dir = "."; // host directory that is the SD card
+
+static Ticker *events[SIM_EVENTS];
+static int nevents = 0;
+
+static LPC_PWM_TypeDef pwm1;
+static LPC_I2C_TypeDef i2c1;
+static LPC_WDT_TypeDef wdt;
+static CoreDebug_Type coredebug;
+static DWT_Type dwt;
+LPC_PWM_TypeDef *LPC_PWM1 = &pwm1;
+LPC_I2C_TypeDef *LPC_I2C1 = &i2c1;
+LPC_WDT_TypeDef *LPC_WDT = &wdt;
+CoreDebug_Type *CoreDebug = &coredebug;
+DWT_Type *DWT = &dwt;
+uint32_t SystemCoreClock = 96000000;
+
+/**
+*** PwmOut: PWM1 counts at SystemCoreClock/4, MR0 is the period, MR5 the duty (p22)
+**/
+void PwmOut::period_us(int us)
+{
+  LPC_PWM1->MR0 = (uint32_t)((uint64_t)us * SystemCoreClock / 4000000);
+  LPC_PWM1->MR5 = 0;
+}
+
+void PwmOut::pulsewidth_us(int us)
+{
+  LPC_PWM1->MR5 = (uint32_t)((uint64_t)us * SystemCoreClock / 4000000);
+}
+
+void PwmOut::write(float v)
+{
+  LPC_PWM1->MR5 = (uint32_t)(v * LPC_PWM1->MR0);
+}
+
+float PwmOut::read()
+{
+  return LPC_PWM1->MR0 ? (float)LPC_PWM1->MR5 / LPC_PWM1->MR0 : 0;
+}
+
+/**
+*** Ticker: (re)start the timer, the first call is after us usec
+**/
+void Ticker::attach_us(void (*f)(void), unsigned int us)
+{
+  int i;
+  fn = f;
+  period = ( us ? us : 1 );
+  next = sim_now + period;
+  for (i=0; i<nevents && events[i] != this; i++)
+    ;
+  if ( i == nevents )
+  {
+    if ( nevents == SIM_EVENTS )
+      error("sim: too many tickers\n");
+    events[nevents++] = this;
+  }
+}
+
+void Ticker::detach()
+{
+  for (int i=0; i<nevents; i++)
+    if ( events[i] == this )
+    {
+      events[i] = events[--nevents];
+      return;
+    }
+}
+
+/**
+*** Advance the clock to the next event and fire it
+**/
+int sim_step()
+{
+  Ticker *t = NULL;
+  for (int i=0; i<nevents; i++)
+    if ( t == NULL || events[i]->next < t->next )
+      t = events[i];
+  if ( t == NULL )
+    return 0;
+  sim_now = t->next;
+  if ( t->oneshot )
+    t->detach();
+  else
+    t->next += t->period;
+  t->fn();
+  if ( sim_event_hook )
+    sim_event_hook();
+  return 1;
+}
+
+void sim_run_until(uint64_t t)
+{
+  for (;;)
+  {
+    int due = 0;
+    for (int i=0; i<nevents && !due; i++)
+      due = events[i]->next <= t;
+    if ( !due )
+      break;
+    sim_step();
+  }
+  if ( t > sim_now )
+    sim_now = t;
+}
+
+void wait(float s) { sim_run_until(sim_now + (uint64_t)(s * 1e6)); }
+void wait_ms(int ms) { sim_run_until(sim_now + ms * 1000ULL); }
+void wait_us(int us) { sim_run_until(sim_now + us); }
+
+int Serial::printf(const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vprintf(fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+void error(const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  exit(1);
+}
+
+extern "C" void mbed_reset()
+{
+  error("sim: reset\n");
+}
+
+/**
+*** File access: "/sd/..." and "/local/..." are mapped to sim_sd_dir
+*** (linked with --wrap=fopen,remove,opendir)
+**/
+static const char *sim_path(const char *path, char *buf, size_t size)
+{
+  static const char *mounts[] = { "/sd", "/local" };
+  for (int i=0; i<2; i++)
+  {
+    size_t n = strlen(mounts[i]);
+    if ( strncmp(path, mounts[i], n) == 0 && (path[n] == '/' || path[n] == 0) )
+    {
+      snprintf(buf, size, "%s/%s", sim_sd_dir, path[n] ? path + n + 1 : "");
+      return buf;
+    }
+  }
+  return path;
+}
+
+extern "C" {
+FILE *__real_fopen(const char *path, const char *mode);
+int __real_remove(const char *path);
+DIR *__real_opendir(const char *path);
+
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+  char buf[512];
+  return __real_fopen(sim_path(path, buf, sizeof(buf)), mode);
+}
+
+int __wrap_remove(const char *path)
+{
+  char buf[512];
+  return __real_remove(sim_path(path, buf, sizeof(buf)));
+}
+
+DIR *__wrap_opendir(const char *path)
+{
+  char buf[512];
+  return __real_opendir(sim_path(path, buf, sizeof(buf)));
+}
+}
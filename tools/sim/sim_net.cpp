@@ -0,0 +1,101 @@
+/**
+ * sim_net.cpp
+ * Run the full laser firmware (main.cpp) on a host (Linux): stand-ins for the network
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * There is no network stack yet (lwIP with a TAP interface): a TFTP transfer is a file
+ * that a test queues, it is written to the SD directory when the firmware "receives" it.
+ * Net::poll() is a background task in every wait loop of the firmware, so it lets the
+ * simulated time pass (like the "sim" task of sim_job.cpp).
+ */
+#include "sim.h"
+#include "EthConfig.h"
+#include "TFTPServer.h"
+
+#define SIM_TFTP_FILES 8
+
+void (*sim_tftp_idle)() = NULL;
+
+static struct { char name[32]; const char *text; } files[SIM_TFTP_FILES];
+static int nfiles = 0, received = 0;
+static TFTPServerState tftp_state = listen;
+
+EthernetNetIf * EthConfig()
+{
+  return new EthernetNetIf();
+}
+
+bool EthSpeed(void)
+{
+  return true;
+}
+
+bool EthLink(void)
+{
+  return true;
+}
+
+void Net::poll()
+{
+  if ( !sim_step() )
+    sim_now += 1000; // nothing scheduled: idle
+}
+
+/**
+*** Queue a file transfer: the file is written to the SD directory when the firmware
+*** receives it, in the order of the calls
+**/
+void sim_tftp_put(const char *name, const char *text)
+{
+  if ( nfiles >= SIM_TFTP_FILES )
+    error("sim: too many files\n");
+  snprintf(files[nfiles].name, sizeof(files[nfiles].name), "%s", name);
+  files[nfiles].text = text;
+  nfiles++;
+}
+
+/**
+*** A queued file is written in one poll (state writing), then the server listens again.
+*** Without queued files sim_tftp_idle() is called: the firmware waits for a file.
+**/
+TFTPServerState TFTPServer::State()
+{
+  if ( tftp_state == writing )
+  {
+    char path[64];
+    snprintf(path, sizeof(path), "/sd/%s", files[received].name);
+    FILE *fp = fopen(path, "w");
+    if ( fp == NULL )
+      error("sim: cannot write %s\n", path);
+    fputs(files[received].text, fp);
+    fclose(fp);
+    received++;
+    tftp_state = listen;
+  }
+  else if ( received < nfiles )
+    tftp_state = writing;
+  else if ( sim_tftp_idle )
+    sim_tftp_idle();
+  return tftp_state;
+}
+
+void TFTPServer::getFilename(char* name)
+{
+  strcpy(name, received > 0 ? files[received-1].name : "");
+}
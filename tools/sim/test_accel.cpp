@@ -0,0 +1,100 @@
+/**
+ * test_accel.cpp
+ * Per axis acceleration limits (x.accel, y.accel): moves along an axis accelerate at that
+ * axis' limit, diagonal moves keep each axis within its own limit
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The acceleration of each axis is the 2nd difference of its sampled position (over 50 msec).
+ * The trapezoid ramps overshoot by up to 10% at the end of the deceleration (the step
+ * recurrence is least accurate at the last steps), hence the tolerance TOL.
+ */
+#include "sim.h"
+#include "planner.h"
+#include "check.h"
+
+#define MAXSAMPLES 10000
+#define H 0.01 // sample interval [sec]
+#define K 5 // 2nd difference over K samples, averages the step quantization
+#define TOL 0.12 // relative
+
+static double xs[MAXSAMPLES], ys[MAXSAMPLES];
+static int nsamples;
+
+static void record(const tSimSample *s)
+{
+  if ( nsamples < MAXSAMPLES )
+  {
+    xs[nsamples] = s->x;
+    ys[nsamples++] = s->y;
+  }
+}
+
+static double max_accel(const double *p)
+{
+  double m = 0;
+  for (int i=K; i<nsamples-K; i++)
+    m = fmax(m, fabs(p[i+K] - 2*p[i] + p[i-K]) / (K*H*K*H));
+  return m;
+}
+
+// line from the origin to x,y [micron]
+static void run(int x, int y)
+{
+  sim_write(0); sim_write(0); sim_write(0);
+  sim_finish();
+  nsamples = 0;
+  sim_sample(H * 1E6, &record);
+  sim_write(1); sim_write(x); sim_write(y);
+  sim_finish();
+  sim_run_until(sim_now + 5 * H * 1E6);
+  sim_sample(0, NULL);
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->speed = cfg->rapidspeed = 100;
+  cfg->accel = 1000;
+  cfg->xaccel = 1000;
+  cfg->yaccel = 250;
+  sim_start();
+  plan_init();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // along x: the light axis accelerates at its own limit
+  run(60000, 0);
+  CHECK_NEAR(max_accel(xs), 1000, 1000 * TOL);
+  CHECK(max_accel(ys) == 0);
+
+  // along y: the heavy axis
+  run(0, 60000);
+  CHECK_NEAR(max_accel(ys), 250, 250 * TOL);
+
+  // 45 degrees: limited by y, path acceleration 354 mm/sec2, 250 per axis
+  run(60000, 60000);
+  CHECK_NEAR(max_accel(xs), 250, 250 * TOL);
+  CHECK_NEAR(max_accel(ys), 250, 250 * TOL);
+
+  // mostly along x (1:4): y stays within its limit, x gets 4 times that
+  run(80000, 20000);
+  CHECK(max_accel(ys) < 250 * (1 + TOL));
+  CHECK_NEAR(max_accel(xs), 4 * max_accel(ys), 40);
+  CHECK(max_accel(xs) < 1000 * (1 + TOL));
+  return check_done();
+}
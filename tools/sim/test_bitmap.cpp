@@ -0,0 +1,95 @@
+/**
+ * test_bitmap.cpp
+ * Bitmap lines: the lead-in reaches the mark speed before the first pixel, also when
+ * travel moves (the lead-in and lead-out) accelerate slower than the lines
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The speed is the difference of the sampled x position, taken while the laser is on.
+ */
+#include "sim.h"
+#include "planner.h"
+#include "check.h"
+
+#define MAXSAMPLES 20000
+
+static double xs[MAXSAMPLES];
+static int on[MAXSAMPLES];
+static int nsamples;
+
+static void record(const tSimSample *s)
+{
+  if ( nsamples < MAXSAMPLES )
+  {
+    xs[nsamples] = s->x;
+    on[nsamples++] = s->laser;
+  }
+}
+
+// one bitmap line of 64 marked pixels from x0 to x1 [micron] at y, sampled every h [usec]
+static void run(int x0, int x1, int y, uint32_t h)
+{
+  sim_write(0); sim_write(x0); sim_write(y);
+  sim_write(9); sim_write(1); sim_write(64); sim_write(-1); sim_write(-1);
+  nsamples = 0;
+  sim_sample(h, &record);
+  sim_write(1); sim_write(x1); sim_write(y);
+  sim_finish();
+  sim_sample(0, NULL);
+}
+
+// lowest and highest speed while the laser is on [mm/sec]
+static void mark_speed(double h, double *vmin, double *vmax)
+{
+  *vmin = 1E9;
+  *vmax = 0;
+  for (int i=1; i<nsamples; i++)
+    if ( on[i-1] && on[i] )
+    {
+      double v = fabs(xs[i] - xs[i-1]) / h;
+      *vmin = fmin(*vmin, v);
+      *vmax = fmax(*vmax, v);
+    }
+}
+
+int main()
+{
+  double vmin, vmax;
+  sim_config(NULL);
+  cfg->speed = cfg->rapidspeed = 50;
+  cfg->accel = 1000;
+  cfg->rapidaccel = 100; // lead-in of 12.5 mm, not 1.25 mm
+  sim_start();
+  plan_init();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // both directions
+  run(50000, 60000, 0, 10000);
+  mark_speed(0.01, &vmin, &vmax);
+  CHECK(nsamples > 0 && vmax > 0);
+  CHECK_NEAR(vmin, 50, 2);
+  CHECK_NEAR(vmax, 50, 2);
+
+  run(60000, 50000, 1000, 10000);
+  mark_speed(0.01, &vmin, &vmax);
+  CHECK(nsamples > 0 && vmax > 0);
+  CHECK_NEAR(vmin, 50, 2);
+  CHECK_NEAR(vmax, 50, 2);
+
+  return check_done();
+}
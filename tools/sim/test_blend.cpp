@@ -0,0 +1,90 @@
+/**
+ * test_blend.cpp
+ * Corner rounding (job param 104): corners between lines are rounded, the lines of an
+ * arc are not (they are already within motion.curve of the arc). The laser stays on along
+ * the rounded corners.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "sim.h"
+#include "check.h"
+
+static double rmin, rmax;
+static int laser_off; // samples with the laser off
+
+// distance to the center of the circle at (10,10) mm
+static void record(const tSimSample *s)
+{
+  if ( !s->laser )
+    laser_off++;
+  double r = sqrt((s->x - 10) * (s->x - 10) + (s->y - 10) * (s->y - 10));
+  rmin = fmin(rmin, r);
+  rmax = fmax(rmax, r);
+}
+
+// run the job words after a move to (20,10) mm with corner rounding blend [micron],
+// returns the number of blocks
+static uint32_t run(const int *job, int n, int blend)
+{
+  tMotionStats st;
+  sim_write(0); sim_write(20000); sim_write(10000);
+  sim_finish();
+  sim_write(7); sim_write(104); sim_write(blend);
+  mot->resetStats();
+  rmin = 1E9;
+  rmax = 0;
+  laser_off = 0;
+  sim_sample(1000, &record);
+  for (int i=0; i<n; i++)
+    sim_write(job[i]);
+  sim_finish();
+  sim_sample(0, NULL);
+  mot->getStats(&st);
+  return st.blocks;
+}
+
+int main()
+{
+  uint32_t n0, n1;
+  int off0;
+  sim_config(NULL);
+  cfg->curve = 10;
+  cfg->merge = 0;
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // full circle with radius 10 mm, lines of 0.09 rad (0.9 mm)
+  int circle[] = { 3, 20000, 10000, 10000, 10000, 1 };
+  n0 = run(circle, 6, 0);
+  n1 = run(circle, 6, 50);
+  CHECK(n0 > 60);
+  CHECK(n1 == n0);
+  CHECK(rmin > 10 - 0.015 && rmax < 10 + 0.01);
+
+  // a square around the circle: the four corners are rounded
+  int square[] = { 1, 20000, 20000, 1, 0, 20000, 1, 0, 0, 1, 20000, 0, 1, 20000, 10000 };
+  n0 = run(square, 15, 0);
+  off0 = laser_off;
+  n1 = run(square, 15, 50);
+  CHECK(n0 == 5);
+  CHECK(n1 > n0 + 3);
+  CHECK(rmax < 10 * sqrt(2.0) - 0.02); // does not reach the corners
+  CHECK(laser_off <= off0); // the arcs are cut as well
+  return check_done();
+}
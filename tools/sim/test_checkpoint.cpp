@@ -0,0 +1,88 @@
+/**
+ * test_checkpoint.cpp
+ * Job checkpoints: a job resumes from the file position of its checkpoint, with the parser
+ * state of the checkpoint, and runs exactly the rest of the job
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The job is fed like LaosMenu does: the file position of each word, then the word.
+ */
+#include "sim.h"
+#include "laosfilesystem.h"
+#include "LaosSched.h"
+#include "check.h"
+
+#define PAIRS 10 // a move and a line each
+
+int main()
+{
+  tCheckpoint cp;
+  tMotionStats st;
+  int found = 0, k;
+  sim_config(NULL);
+  sim_start();
+
+  // the words have different lengths: the file position is not a multiple of the word count
+  FILE *fp = fopen("/sd/job.lgc", "w");
+  fprintf(fp, "7 100 5000\n");
+  for (int i=0; i<PAIRS; i++)
+    fprintf(fp, "0 %d 0\n1 %d 5000\n", i * 2000, i * 2000);
+  fclose(fp);
+
+  // run until the checkpoint after the first one, then stop
+  fp = fopen("/sd/job.lgc", "r");
+  while ( !found && (!feof(fp) || mot->queue() > 0) )
+  {
+    if ( feof(fp) || !mot->ready() )
+      sched_run();
+    else
+    {
+      mot->setJobOffset(ftell(fp));
+      mot->write(readint(fp), MODE_RUN);
+    }
+    if ( mot->checkpoint(&cp) )
+      found = (cp.words > 3);
+  }
+  sim_finish();
+  CHECK(found);
+  CHECK(cp.speed == cfg->speed / 2);
+  CHECK((cp.words - 3) % 6 == 0); // at a move
+  k = (cp.words - 3) / 6;
+
+  // resume: the word at the checkpoint is the move, then the rest of the job
+  fseek(fp, cp.offset, SEEK_SET);
+  CHECK(readint(fp) == 0);
+  CHECK(readint(fp) == k * 2000);
+  mot->reset();
+  mot->resetStats();
+  fseek(fp, cp.offset, SEEK_SET);
+  mot->restore(&cp);
+  while ( !feof(fp) )
+  {
+    mot->setJobOffset(ftell(fp));
+    sim_write(readint(fp));
+  }
+  fclose(fp);
+  sim_finish();
+  mot->getStats(&st);
+  CHECK(st.blocks == (uint32_t)(2 * (PAIRS - k)));
+  CHECK(actpos_x == (PAIRS - 1) * 2000 * 200 / 1000);
+  CHECK(actpos_y == 5000 * 200 / 1000);
+  remove("/sd/job.lgc");
+  return check_done();
+}
@@ -0,0 +1,163 @@
+/**
+ * test_curve.cpp
+ * Arcs and cubic bezier curves (job commands 3 and 6): the path stays within the chord
+ * error (motion.curve) of the curve, is continuous and ends exactly on the end point
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The deviation is the distance of the sampled positions to the exact curve, the continuity
+ * is the largest distance between two samples. The steps (5 micron per axis) add to both.
+ */
+#include "sim.h"
+#include "check.h"
+
+#define MAXSAMPLES 20000
+#define H 0.001 // sample interval [sec]
+#define STEP 0.005 // [mm]
+
+static double xs[MAXSAMPLES], ys[MAXSAMPLES];
+static int nsamples;
+
+static void record(const tSimSample *s)
+{
+  if ( nsamples < MAXSAMPLES )
+  {
+    xs[nsamples] = s->x;
+    ys[nsamples++] = s->y;
+  }
+}
+
+// move to x0,y0, then run the curve command, returns the number of blocks
+static uint32_t run(int x0, int y0, const int *cmd, int n)
+{
+  tMotionStats st;
+  sim_write(0); sim_write(x0); sim_write(y0);
+  sim_finish();
+  mot->resetStats();
+  nsamples = 0;
+  sim_sample(H * 1E6, &record);
+  for (int i=0; i<n; i++)
+    sim_write(cmd[i]);
+  sim_finish();
+  sim_sample(0, NULL);
+  mot->getStats(&st);
+  return st.blocks;
+}
+
+// largest distance between two samples [mm]
+static double max_jump()
+{
+  double m = 0;
+  for (int i=1; i<nsamples; i++)
+    m = fmax(m, sqrt((xs[i] - xs[i-1]) * (xs[i] - xs[i-1]) + (ys[i] - ys[i-1]) * (ys[i] - ys[i-1])));
+  return m;
+}
+
+// largest distance of the samples to the circle at cx,cy with radius r [mm]
+static double circle_error(double cx, double cy, double r)
+{
+  double m = 0;
+  for (int i=0; i<nsamples; i++)
+    m = fmax(m, fabs(sqrt((xs[i] - cx) * (xs[i] - cx) + (ys[i] - cy) * (ys[i] - cy)) - r));
+  return m;
+}
+
+// angle swept by the samples around cx,cy [rad], > 0: counterclockwise
+static double sweep(double cx, double cy)
+{
+  double a = 0, d;
+  for (int i=1; i<nsamples; i++)
+  {
+    d = atan2(ys[i] - cy, xs[i] - cx) - atan2(ys[i-1] - cy, xs[i-1] - cx);
+    a += ( d > M_PI ? d - 2 * M_PI : d < -M_PI ? d + 2 * M_PI : d );
+  }
+  return a;
+}
+
+// largest distance of the samples to the bezier curve p[0..7] (x,y of 4 points) [mm]
+static double bezier_error(const double *p)
+{
+  double m = 0;
+  for (int i=0; i<nsamples; i++)
+  {
+    double d = 1E9;
+    for (int j=0; j<=4000; j++)
+    {
+      double t = j / 4000.0, u = 1 - t;
+      double bx = u*u*u * p[0] + 3*u*u*t * p[2] + 3*u*t*t * p[4] + t*t*t * p[6];
+      double by = u*u*u * p[1] + 3*u*u*t * p[3] + 3*u*t*t * p[5] + t*t*t * p[7];
+      d = fmin(d, sqrt((xs[i] - bx) * (xs[i] - bx) + (ys[i] - by) * (ys[i] - by)));
+    }
+    m = fmax(m, d);
+  }
+  return m;
+}
+
+int main()
+{
+  uint32_t n10, n100;
+  double vh = 50 * H; // distance per sample at 50 mm/sec [mm]
+  sim_config(NULL);
+  cfg->speed = cfg->rapidspeed = 50;
+  cfg->accel = 1000;
+  cfg->blend = 0;
+  cfg->merge = 0;
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // counterclockwise quarter circle around (10,10) mm, radius 10 mm, chord error 50 micron
+  cfg->curve = 50;
+  int ccw[] = { 3, 10000, 20000, 10000, 10000, 1 };
+  run(20000, 10000, ccw, 6);
+  CHECK(circle_error(10, 10, 10) < 0.05 + STEP);
+  CHECK_NEAR(sweep(10, 10), M_PI / 2, 0.01);
+  CHECK(max_jump() < vh + 2 * STEP);
+  CHECK(actpos_x == 10000 * 200 / 1000 && actpos_y == 20000 * 200 / 1000);
+
+  // clockwise to the same point: three quarters the other way
+  int cw[] = { 3, 10000, 20000, 10000, 10000, 0 };
+  run(20000, 10000, cw, 6);
+  CHECK(circle_error(10, 10, 10) < 0.05 + STEP);
+  CHECK_NEAR(sweep(10, 10), -3 * M_PI / 2, 0.01);
+  CHECK(max_jump() < vh + 2 * STEP);
+
+  // full circle: equal start and end point
+  int full[] = { 3, 20000, 10000, 10000, 10000, 1 };
+  run(20000, 10000, full, 6);
+  CHECK(circle_error(10, 10, 10) < 0.05 + STEP);
+  CHECK_NEAR(sweep(10, 10), 2 * M_PI, 0.01);
+  CHECK(actpos_x == 20000 * 200 / 1000 && actpos_y == 10000 * 200 / 1000);
+
+  // the number of lines grows with 1/sqrt(chord error)
+  cfg->curve = 10;
+  n10 = run(20000, 10000, full, 6);
+  CHECK(circle_error(10, 10, 10) < 0.01 + STEP);
+  cfg->curve = 100;
+  n100 = run(20000, 10000, full, 6);
+  CHECK(n10 > 2.5 * n100 && n10 < 3.8 * n100);
+
+  // cubic bezier from (10,10) over (10,30) and (30,30) to (30,10) mm
+  cfg->curve = 50;
+  int bez[] = { 6, 10000, 30000, 30000, 30000, 30000, 10000 };
+  double p[] = { 10, 10, 10, 30, 30, 30, 30, 10 };
+  run(10000, 10000, bez, 7);
+  CHECK(bezier_error(p) < 0.05 + STEP);
+  CHECK(max_jump() < vh + 2 * STEP);
+  CHECK(actpos_x == 30000 * 200 / 1000 && actpos_y == 10000 * 200 / 1000);
+  return check_done();
+}
@@ -0,0 +1,82 @@
+/**
+ * test_fw_job.cpp
+ * The full firmware (main.cpp, LaosMenu): boot, receive a job file by TFTP, run it,
+ * remove it and log it
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The checks are done when the firmware waits for the next file.
+ */
+#include "sim.h"
+#include "pins.h"
+#include "LaosSched.h"
+#include "check.h"
+
+static int32_t xmax, ymax;
+static int laser_events; // timer events with the laser on
+
+static void record()
+{
+  xmax = ( actpos_x > xmax ? actpos_x : xmax );
+  ymax = ( actpos_y > ymax ? actpos_y : ymax );
+  if ( laser != NULL && laser->read() == LASERON )
+    laser_events++;
+}
+
+static void done()
+{
+  char line[128];
+  int logged = 0;
+  uint64_t t;
+
+  // the move to the rest position, then the job log task (once per second)
+  while ( mot->queue() > 0 ) sched_run();
+  t = sim_now + 2000000;
+  while ( sim_now < t ) sched_run();
+
+  CHECK(xmax == 10000 * 200 / 1000);
+  CHECK(ymax == 5000 * 200 / 1000);
+  CHECK(laser_events > 0);
+  CHECK(actpos_x == 0 && actpos_y == 0); // sys.rest
+  CHECK(fopen("/sd/job.lgc", "r") == NULL); // removed after the job
+  FILE *fp = fopen("/sd/joblog.csv", "r");
+  CHECK(fp != NULL);
+  if ( fp )
+  {
+    while ( fgets(line, sizeof(line), fp) )
+      logged += (strstr(line, "job.lgc") != NULL);
+    fclose(fp);
+  }
+  CHECK(logged == 1);
+  exit(check_done());
+}
+
+int main()
+{
+  static char dir[] = "/tmp/laos-fw-XXXXXX";
+  if ( mkdtemp(dir) == NULL )
+    return 1;
+  sim_sd_dir = dir;
+
+  // two lines at 100 mm/sec, then a move back
+  sim_tftp_put("job.lgc", "7 100 10000\n1 10000 0\n1 10000 5000\n0 0 0\n");
+  sim_tftp_idle = &done;
+  sim_event_hook = &record;
+  laos_main();
+  return 1; // not reached
+}
@@ -0,0 +1,96 @@
+/**
+ * test_hold.cpp
+ * Feed hold: the motion stops on the path and keeps its position, resume() continues
+ * at the nominal speed and ends exactly at the target. The laser is off from the moment the
+ * hold is requested.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "sim.h"
+#include "planner.h"
+#include "pins.h"
+#include "LaosSched.h"
+#include "check.h"
+
+static double vmax, xlast;
+static int laser_fired; // timer events with the laser on during the hold
+
+// highest speed along x [mm/sec], sampled every 10 msec
+static void record(const tSimSample *s)
+{
+  vmax = fmax(vmax, fabs(s->x - xlast) / 0.01);
+  xlast = s->x;
+}
+
+static void check_laser()
+{
+  if ( laser->read() == LASERON )
+    laser_fired++;
+}
+
+// hold a line to x [micron] after t [usec], then resume
+static void run(int x, uint64_t t)
+{
+  int32_t hx, hy;
+  sim_write(1); sim_write(x); sim_write(0);
+  sim_write(1); sim_write(x); sim_write(20000); // stays in the queue during the hold
+  mot->queue(); // start the held back line
+  sim_run_until(sim_now + t);
+  CHECK(laser->read() == LASERON);
+  mot->hold();
+  CHECK(laser->read() != LASERON);
+  laser_fired = 0;
+  sim_event_hook = &check_laser;
+  while ( !mot->isHeld() ) sched_run();
+  sim_event_hook = NULL;
+  CHECK(laser_fired == 0);
+  hx = actpos_x;
+  hy = actpos_y;
+  CHECK(hx > 0 && hx < x * 200 / 1000);
+  CHECK(hy == 0);
+  sim_run_until(sim_now + 1000000);
+  CHECK(actpos_x == hx && actpos_y == hy); // stopped
+  CHECK(mot->queue() > 0);
+
+  vmax = 0;
+  xlast = actpos_x / 200.0;
+  sim_sample(10000, &record);
+  mot->resume();
+  sim_finish();
+  sim_sample(0, NULL);
+  CHECK_NEAR(vmax, 50, 2); // not slowed down by the hold
+  CHECK(actpos_x == x * 200 / 1000);
+  CHECK(actpos_y == 20000 * 200 / 1000);
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->speed = cfg->rapidspeed = 50;
+  cfg->accel = 1000;
+  sim_start();
+  plan_init();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  run(100000, 500000); // at full speed
+  sim_write(0); sim_write(0); sim_write(0);
+  sim_finish();
+  run(100000, 50000); // while accelerating
+  return check_done();
+}
@@ -0,0 +1,69 @@
+/**
+ * test_home.cpp
+ * Homing: the position is only set when every axis reached its end-stop
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The home switches are pressed (x.pol 0) or open for the whole homing.
+ */
+#include "sim.h"
+#include "pins.h"
+#include "check.h"
+
+int main()
+{
+  int x, y, z;
+  sim_config(NULL);
+  cfg->xmax = cfg->ymax = 20000; // homing moves of 40 mm
+  sim_start();
+  dsp = new LaosDisplay();
+
+  // both switches pressed
+  xhome.value = yhome.value = 0;
+  mot->home(1000, 2000, 0);
+  mot->getPosition(&x, &y, &z);
+  CHECK(mot->isHome);
+  CHECK(x == 1000 && y == 2000);
+
+  // the Y switch is never reached: not homed, the position is not set
+  mot->setPosition(0, 0, 0);
+  yhome.value = 1;
+  mot->home(1000, 2000, 0);
+  mot->getPosition(&x, &y, &z);
+  CHECK(!mot->isHome);
+  CHECK(x != 1000 || y != 2000);
+
+  // neither switch
+  mot->setPosition(0, 0, 0);
+  xhome.value = 1;
+  mot->home(1000, 2000, 0);
+  mot->getPosition(&x, &y, &z);
+  CHECK(!mot->isHome);
+  CHECK(x != 1000 || y != 2000);
+
+  // a homed machine, then no homing range (x.max = x.min): the planner drops the fast
+  // end-stop move, its end-stops are not reached
+  xhome.value = yhome.value = 0;
+  mot->home(1000, 2000, 0);
+  CHECK(mot->isHome);
+  cfg->xmax = cfg->xmin;
+  cfg->ymax = cfg->ymin;
+  mot->home(1000, 2000, 0);
+  CHECK(!mot->isHome);
+  return check_done();
+}
@@ -0,0 +1,108 @@
+/**
+ * test_laser.cpp
+ * Laser output driver: the PWM match register is only written (and latched) when the
+ * power changes, not on every step event
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * After each timer event the latch register (LER) is read and cleared: a set latch bit is
+ * a register update. The updates are compared with the step events and the laser switches.
+ */
+#include "sim.h"
+#include "pins.h"
+#include "check.h"
+
+static int events, latches, switches, last, lit;
+static uint32_t mr5;
+
+static void count()
+{
+  int state = laser->read();
+  events++;
+  if ( LPC_PWM1->LER & LASER_PWM_LER )
+  {
+    latches++;
+    LPC_PWM1->LER = 0;
+  }
+  if ( state != last )
+    switches++;
+  last = state;
+  if ( state == LASERON && !lit )
+  {
+    lit = 1;
+    mr5 = LPC_PWM1->LASER_PWM_MR;
+  }
+}
+
+static void start()
+{
+  sim_write(0); sim_write(20000); sim_write(0);
+  sim_finish();
+  events = latches = switches = lit = 0;
+  last = laser->read();
+  LPC_PWM1->LER = 0;
+  sim_event_hook = &count;
+}
+
+static void stop()
+{
+  sim_finish();
+  sim_run_until(sim_now + 10000); // the step interrupt goes idle and switches the laser off
+  sim_event_hook = NULL;
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->pwmmin = 0;
+  cfg->pwmmax = 100;
+  cfg->speed = cfg->rapidspeed = 50;
+  cfg->accel = 1000;
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+  sim_write(7); sim_write(101); sim_write(5000); // 50% power
+
+  // a line at constant power: written when the laser switches on and off
+  cfg->scalemin = 100;
+  start();
+  sim_write(1); sim_write(60000); sim_write(0);
+  stop();
+  CHECK(events > 7000); // 8000 steps
+  CHECK(switches == 2);
+  CHECK(latches <= 2);
+  CHECK_NEAR(mr5, LPC_PWM1->MR0 / 2, 1);
+
+  // power scaled with the speed: written during the ramps only, when the match count changes
+  cfg->scalemin = 20;
+  start();
+  sim_write(1); sim_write(60000); sim_write(0);
+  stop();
+  CHECK(latches > 10);
+  CHECK(latches < events / 10);
+
+  // bitmap line of alternating pixels: one update per laser switch
+  cfg->scalemin = 100;
+  start();
+  sim_write(9); sim_write(1); sim_write(64);
+  sim_write(0x55555555); sim_write(0x55555555);
+  sim_write(1); sim_write(30000); sim_write(0);
+  stop();
+  CHECK(switches >= 63);
+  CHECK(latches <= switches);
+  return check_done();
+}
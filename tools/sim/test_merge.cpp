@@ -0,0 +1,77 @@
+/**
+ * test_merge.cpp
+ * Segment merging (motion.merge): off in the shipped config, the path visits every vertex;
+ * when on, nearly collinear segments are merged and the path stays within the tolerance
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The job is a zigzag of 40 lines of 0.5 mm along x, 20 micron high.
+ */
+#include "sim.h"
+#include "check.h"
+
+static double ymax;
+
+static void record(const tSimSample *s)
+{
+  ymax = fmax(ymax, s->y);
+}
+
+// run the zigzag, returns the number of blocks
+static uint32_t run()
+{
+  tMotionStats st;
+  sim_write(0); sim_write(0); sim_write(0);
+  sim_finish();
+  mot->resetStats();
+  ymax = 0;
+  sim_sample(500, &record);
+  for (int i=1; i<=40; i++)
+  {
+    sim_write(1); sim_write(500 * i); sim_write(i % 2 ? 20 : 0);
+  }
+  sim_finish();
+  sim_sample(0, NULL);
+  mot->getStats(&st);
+  CHECK(actpos_x == 20000 * 200 / 1000 && actpos_y == 0);
+  return st.blocks;
+}
+
+int main()
+{
+  // the shipped config does not change the path
+  sim_config("../../config");
+  CHECK(cfg->merge == 0);
+  CHECK(cfg->blend == 0);
+
+  sim_config(NULL);
+  cfg->blend = 0;
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // off: every vertex is a block and is reached
+  cfg->merge = 0;
+  CHECK(run() >= 40);
+  CHECK_NEAR(ymax, 0.02, 0.003);
+
+  // 50 micron: one line, within the tolerance
+  cfg->merge = 50;
+  CHECK(run() < 5);
+  CHECK(ymax <= 0.05);
+  return check_done();
+}
@@ -0,0 +1,93 @@
+/**
+ * test_pixel.cpp
+ * Bitmap pixel to position mapping: the laser switches at the pixel boundaries, with the
+ * step based pixels and with the time based pixel clock (laser.pixelclock)
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The lines alternate marked and blank pixels, from x=20 mm, at 400 steps/mm. Each switch of
+ * the laser is compared with the nearest pixel boundary.
+ */
+#include "sim.h"
+#include "check.h"
+
+#define PIXELS 128
+#define X0 20.0 // [mm]
+
+static double pixel; // [mm]
+static int last, switches, wrong;
+static double err; // largest distance of a switch to its pixel boundary [pixels]
+
+static void record(const tSimSample *s)
+{
+  double p = (s->x - X0) / pixel;
+  int b = (int)floor(p + 0.5); // nearest boundary
+  if ( s->laser != last )
+  {
+    switches++;
+    err = fmax(err, fabs(p - b));
+    if ( s->laser != (b % 2 == 0) ) // pixel b (after the boundary, +X) is marked if even
+      wrong++;
+  }
+  last = s->laser;
+}
+
+// one line of PIXELS pixels of size p [mm] in +X direction, at speed v [mm/sec]
+static void run(double p, int v, int clock)
+{
+  pixel = p;
+  cfg->pixelclock = clock;
+  sim_write(7); sim_write(100); sim_write(v * 100); // % of motion.speed (100 mm/sec)
+  sim_write(0); sim_write((int)(X0 * 1000)); sim_write(0);
+  sim_finish();
+  last = switches = wrong = 0;
+  err = 0;
+  sim_sample(10, &record);
+  sim_write(9); sim_write(1); sim_write(PIXELS);
+  for (int i=0; i<PIXELS/32; i++)
+    sim_write(0x55555555);
+  sim_write(1); sim_write((int)((X0 + PIXELS * p) * 1000)); sim_write(0);
+  sim_finish();
+  sim_sample(0, NULL);
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->xscale = cfg->yscale = 400000;
+  cfg->speed = cfg->rapidspeed = 100;
+  cfg->accel = 1000;
+  sim_start();
+
+  for (int clock=0; clock<=1; clock++)
+  {
+    // 0.1 mm pixels: 40 steps each
+    run(0.1, 50, clock);
+    CHECK(switches == PIXELS);
+    CHECK(wrong == 0);
+    CHECK(err < 0.1);
+
+    // 300 dpi: 33.9 steps per pixel, does not divide evenly
+    run(25.4 / 300, 50, clock);
+    CHECK(switches == PIXELS);
+    CHECK(wrong == 0);
+    CHECK(err < 0.1);
+    printf("pixel clock %d: max error %.3f pixel\n", clock, err);
+  }
+  return check_done();
+}
@@ -0,0 +1,110 @@
+/**
+ * test_power.cpp
+ * Laser power scaled with the speed (laser.scale.min): the PWM duty follows
+ * min + (1 - min) * v / vnominal during the ramps, and is the full power at the nominal speed
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The speed is the central difference of the sampled x position, the duty is read from
+ * the PWM1 match register of the laser output.
+ */
+#include "sim.h"
+#include "pins.h"
+#include "stepper.h"
+#include "check.h"
+
+#define MAXSAMPLES 2000
+#define H 0.005 // sample interval [sec]
+
+static double xs[MAXSAMPLES], duty[MAXSAMPLES];
+static int on[MAXSAMPLES];
+static int nsamples;
+
+static void record(const tSimSample *s)
+{
+  if ( nsamples < MAXSAMPLES )
+  {
+    xs[nsamples] = s->x;
+    duty[nsamples] = (double)LPC_PWM1->MR5 / LPC_PWM1->MR0;
+    on[nsamples++] = s->laser;
+  }
+}
+
+// a 20 mm line at 50 mm/sec and power [0..10000], returns the largest difference
+// between the duty and the expected curve; *nominal: samples at the nominal speed
+static double run(int power, double scalemin, int *nominal)
+{
+  double v, expect, err = 0;
+  cfg->scalemin = (int)(scalemin * 100);
+  sim_write(0); sim_write(0); sim_write(0);
+  sim_finish();
+  nsamples = 0;
+  sim_sample(H * 1E6, &record);
+  sim_write(7); sim_write(101); sim_write(power);
+  sim_write(1); sim_write(20000); sim_write(0);
+  sim_finish();
+  sim_sample(0, NULL);
+  *nominal = 0;
+  for (int i=1; i<nsamples-1; i++)
+    if ( on[i-1] && on[i] && on[i+1] )
+    {
+      v = (xs[i+1] - xs[i-1]) / (2 * H) / 50.0; // fraction of the nominal speed
+      expect = power / 10000.0 * (scalemin + (1 - scalemin) * fmin(v, 1.0));
+      err = fmax(err, fabs(duty[i] - expect));
+      if ( v > 0.99 )
+        (*nominal)++;
+    }
+  return err;
+}
+
+int main()
+{
+  int nominal;
+  sim_config(NULL);
+  cfg->pwmmin = 0;
+  cfg->pwmmax = 100;
+  cfg->speed = cfg->rapidspeed = 50;
+  cfg->accel = 200; // ramps of 6.25 mm
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+
+  // scaled down to 20% at standstill
+  CHECK(run(10000, 0.2, &nominal) < 0.04);
+  CHECK(nominal > 20);
+
+  // half power, scaled down to 50%
+  CHECK(run(5000, 0.5, &nominal) < 0.02);
+
+  // laser.scale.min 100: no scaling
+  CHECK(run(10000, 1.0, &nominal) < 0.001);
+
+  // laser.pwm.freq 50: a period of 480000 counts, the match counts must not overflow
+  pwm.period(1.0 / 50);
+  laser_init();
+  CHECK(run(10000, 0.2, &nominal) < 0.04);
+  CHECK(run(5000, 0.5, &nominal) < 0.02);
+
+  // laser.pwm.max above 100: the duty is clamped to the period
+  cfg->pwmmax = 150;
+  run(10000, 1.0, &nominal);
+  double dmax = 0;
+  for (int i=0; i<nsamples; i++)
+    dmax = fmax(dmax, duty[i]);
+  CHECK_NEAR(dmax, 1.0, 1E-6);
+  return check_done();
+}
@@ -0,0 +1,133 @@
+/**
+ * test_ppi.cpp
+ * Pulses-per-inch mode (job params 102 and 103): one pulse of fixed length every pitch of
+ * path length, independent of the speed, also during the ramps and across blocks. After a
+ * continuous line the laser is off until the first pulse.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The laser output and the position are checked after each timer event: the path length at
+ * the start of each pulse and the pulse lengths are logged.
+ */
+#include "sim.h"
+#include "pins.h"
+#include "check.h"
+
+#define MAXPULSES 1000
+
+static double ps[MAXPULSES]; // path length at the pulses [mm]
+static double path; // path length [mm]
+static int32_t lx, ly; // position at the last event [steps]
+static int npulses, last;
+static uint64_t t_on;
+static uint32_t len_min, len_max; // pulse length [usec]
+static double first_off; // path length where the laser went off the first time [mm]
+
+static void log_pulse()
+{
+  int state = laser->read();
+  path += sqrt((double)(actpos_x - lx) * (actpos_x - lx) + (double)(actpos_y - ly) * (actpos_y - ly)) / 200.0;
+  lx = actpos_x;
+  ly = actpos_y;
+  if ( state == LASERON && last != LASERON && npulses < MAXPULSES )
+  {
+    ps[npulses++] = path;
+    t_on = sim_now;
+  }
+  if ( state != LASERON && last == LASERON )
+  {
+    if ( first_off < 0 )
+      first_off = path;
+    len_min = ( sim_now - t_on < len_min ? sim_now - t_on : len_min );
+    len_max = ( sim_now - t_on > len_max ? sim_now - t_on : len_max );
+  }
+  last = state;
+}
+
+// lines through the points [micron] at speed [% of motion.speed] with pitch [micron] and pulse [usec],
+// after a continuous line of cut [micron] along x
+static void run(const int *xy, int n, int speed, int pitch, int pulse, int cut = 0)
+{
+  sim_write(0); sim_write(0); sim_write(0);
+  sim_finish();
+  sim_write(7); sim_write(100); sim_write(speed * 100);
+  npulses = 0;
+  first_off = -1;
+  path = 0;
+  lx = actpos_x;
+  ly = actpos_y;
+  len_min = 0xffffffff;
+  len_max = 0;
+  last = laser->read();
+  sim_event_hook = &log_pulse;
+  if ( cut )
+  {
+    sim_write(7); sim_write(102); sim_write(0);
+    sim_write(1); sim_write(cut); sim_write(0);
+  }
+  sim_write(7); sim_write(102); sim_write(pitch);
+  sim_write(7); sim_write(103); sim_write(pulse);
+  for (int i=0; i<n; i+=2)
+  {
+    sim_write(1); sim_write(xy[i]); sim_write(xy[i+1]);
+  }
+  sim_finish();
+  sim_run_until(sim_now + 10000);
+  sim_event_hook = NULL;
+}
+
+// largest difference between the path length between two pulses and the pitch [mm]
+static double pitch_error(double pitch)
+{
+  double err = 0;
+  for (int i=1; i<npulses; i++)
+    err = fmax(err, fabs(ps[i] - ps[i-1] - pitch));
+  return err;
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->speed = cfg->rapidspeed = 100;
+  cfg->accel = 500;
+  cfg->blend = 0;
+  sim_start();
+
+  // 20 mm along x, pitch 0.5 mm: 40 pulses at any speed
+  int line[] = { 20000, 0 };
+  for (int speed=10; speed<=100; speed*=10)
+  {
+    run(line, 2, speed, 500, 100);
+    CHECK_NEAR(npulses, 40, 1);
+    CHECK(pitch_error(0.5) < 0.011); // 2 steps
+    CHECK(len_min >= 100 && len_max <= 110);
+  }
+
+  // diagonal, then a second block: the pitch is along the path and carries over
+  int path[] = { 10000, 10000, 20000, 10000 };
+  run(path, 4, 50, 250, 50);
+  CHECK_NEAR(npulses, (10 * sqrt(2.0) + 10) / 0.25, 1);
+  CHECK(pitch_error(0.25) < 0.011);
+  CHECK(len_min >= 50 && len_max <= 60);
+
+  // a continuous line of 10 mm, then pulses: the cut ends at the start of the ppi line
+  run(line, 2, 50, 500, 100, 10000);
+  CHECK_NEAR(first_off, 10, 0.011);
+  CHECK_NEAR(npulses, 1 + 20, 1);
+  return check_done();
+}
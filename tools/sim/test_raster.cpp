@@ -0,0 +1,103 @@
+/**
+ * test_raster.cpp
+ * Sparse bitmap lines: blank runs are crossed with rapid moves, the laser only fires on
+ * the marked pixels. Reports the time saved against crossing the whole line at mark speed.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The lines are 256 pixels of 0.25 mm from x=20 to x=84 mm, marked at 10 mm/sec.
+ */
+#include "sim.h"
+#include <string.h>
+#include "check.h"
+
+#define PIXELS 256
+#define PIXEL 0.25 // [mm]
+#define X0 20.0 // [mm]
+
+static unsigned long bits[PIXELS / 32];
+static int lit, outside; // laser on samples, and those away from the marked pixels
+
+static int marked(int i)
+{
+  return i >= 0 && i < PIXELS && (bits[i / 32] & (1UL << (i % 32)));
+}
+
+static void record(const tSimSample *s)
+{
+  int i = (int)floor((s->x - X0) / PIXEL);
+  lit += s->laser;
+  if ( s->laser && !marked(i) && !marked(i-1) && !marked(i+1) )
+    outside++;
+}
+
+// one bitmap line in direction dir (+1/-1) at y [micron], returns its time [sec]
+static double run(int dir, int y)
+{
+  int x0 = (dir > 0 ? X0 : X0 + PIXELS * PIXEL) * 1000, x1 = (dir > 0 ? X0 + PIXELS * PIXEL : X0) * 1000;
+  uint64_t start;
+  sim_write(0); sim_write(x0); sim_write(y);
+  sim_finish();
+  start = sim_now;
+  sim_sample(1000, &record);
+  sim_write(9); sim_write(1); sim_write(PIXELS);
+  for (int i=0; i<PIXELS/32; i++)
+    sim_write((int)bits[i]);
+  sim_write(1); sim_write(x1); sim_write(y);
+  sim_finish();
+  sim_sample(0, NULL);
+  return (sim_now - start) / 1E6;
+}
+
+// a recorded raster line: marked runs [first, last] of pixels
+static double job(const char *name, const int *runs, int n)
+{
+  double t, full = 2 * PIXELS * PIXEL / 10.0; // both directions at mark speed
+  memset(bits, 0, sizeof(bits));
+  for (int r=0; r<n; r+=2)
+    for (int i=runs[r]; i<=runs[r+1]; i++)
+      bits[i / 32] |= (1UL << (i % 32));
+  lit = outside = 0;
+  t = run(1, 0) + run(-1, 1000);
+  CHECK(lit > 0 && outside == 0);
+  printf("%s: %.2f sec, %.2f sec at mark speed, saved %.0f%%\n", name, t, full, 100 * (full - t) / full);
+  return t / full;
+}
+
+int main()
+{
+  sim_config(NULL);
+  cfg->speed = 100;
+  cfg->rapidspeed = 100;
+  cfg->accel = 1000;
+  sim_start();
+  sim_write(7); sim_write(100); sim_write(1000); // 10% of motion.speed: 10 mm/sec
+
+  // logo outline: two short runs far apart
+  int logo[] = { 10, 25, 230, 245 };
+  CHECK(job("logo", logo, 4) < 0.4);
+
+  // text: short runs with small gaps (not worth a rapid move) and one large gap
+  int text[] = { 40, 44, 48, 52, 56, 60, 200, 204, 208, 212 };
+  CHECK(job("text", text, 10) < 0.7);
+
+  // a solid line: nothing to skip, about the time at mark speed (plus the overscan)
+  int solid[] = { 0, 255 };
+  CHECK(job("solid", solid, 2) > 0.98);
+  return check_done();
+}
@@ -0,0 +1,145 @@
+/**
+ * test_sched.cpp
+ * Cooperative scheduler on a fake clock: periods, time budgets, waiting inside a task
+ * and clock wrap around
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The clock only moves when a test or a task advances it.
+ */
+#include "LaosSched.h"
+#include "check.h"
+
+static uint32_t fake_now;
+static int fast_runs, slow_runs, bg_runs, fg_runs, waiter_runs, depth, reentered;
+static uint32_t slow_start[100];
+
+static uint32_t fake_clock()
+{
+  return fake_now;
+}
+
+static void fast() { fast_runs++; }
+// takes 300 usec
+static void slow()
+{
+  if ( slow_runs < 100 )
+    slow_start[slow_runs] = fake_now;
+  slow_runs++;
+  fake_now += 300;
+}
+
+// all runs of slow started one period apart
+static int slow_periodic(uint32_t period)
+{
+  for (int i=1; i<slow_runs && i<100; i++)
+    if ( slow_start[i] - slow_start[i-1] != period )
+      return 0;
+  return 1;
+}
+static void bg() { bg_runs++; }
+static void fg() { fg_runs++; }
+
+// uses its time budget in steps of 10 usec
+static void greedy()
+{
+  while ( !sched_expired() )
+    fake_now += 10;
+}
+
+// waits 5 msec for something, running the scheduler meanwhile
+static void waiter()
+{
+  uint32_t start = fake_now;
+  waiter_runs++;
+  if ( depth++ )
+    reentered++;
+  while ( fake_now - start < 5000 )
+  {
+    fake_now += 100;
+    sched_run();
+  }
+  depth--;
+}
+
+int main()
+{
+  int id;
+
+  // periods: every run, or at most once per period
+  sched_init(&fake_clock);
+  CHECK(sched_add("fast", &fast, 0, 100, 0) == 0);
+  CHECK(sched_add("slow", &slow, 1000, 200, 0) == 1);
+  for (int i=0; i<100; i++)
+  {
+    sched_run();
+    fake_now += 100;
+  }
+  CHECK(fast_runs == 100);
+  CHECK(slow_start[0] == 1000); // one period after sched_add()
+  CHECK(slow_runs == 13); // 10 msec, plus 300 usec per run
+  CHECK(slow_periodic(1000)); // from start to start
+  CHECK(sched_task(1)->runs == (uint32_t)slow_runs);
+  CHECK(sched_task(1)->overruns == (uint32_t)slow_runs); // 300 usec with a budget of 200
+  CHECK(sched_task(1)->maxtime == 300);
+  CHECK(sched_task(0)->overruns == 0);
+  CHECK(sched_task(2) == NULL);
+
+  // time budget: sched_expired() ends the task after its budget
+  sched_init(&fake_clock);
+  id = sched_add("greedy", &greedy, 0, 2000, 0);
+  sched_run();
+  CHECK(sched_task(id)->maxtime == 2000);
+  CHECK(sched_task(id)->overruns == 0);
+  CHECK(!sched_expired()); // not in a task
+
+  // waiting inside a task: only the background tasks run, the waiting task is not re-entered
+  sched_init(&fake_clock);
+  bg_runs = fg_runs = 0;
+  sched_add("waiter", &waiter, 0, 10000, 0);
+  sched_add("bg", &bg, 0, 100, SCHED_BACKGROUND);
+  sched_add("fg", &fg, 0, 100, 0);
+  sched_run();
+  CHECK(waiter_runs == 1);
+  CHECK(reentered == 0);
+  CHECK(bg_runs == 50 + 1); // 50 times while waiting, once after the waiter
+  CHECK(fg_runs == 1);
+
+  // the clock wraps around
+  sched_init(&fake_clock);
+  fake_now = 0xfffffe00; // the first run is due after the wrap
+  slow_runs = 0;
+  sched_add("slow", &slow, 1000, 500, 0);
+  for (int i=0; i<40; i++)
+  {
+    sched_run();
+    fake_now += 100;
+  }
+  CHECK(slow_runs == 5);
+  CHECK(slow_start[0] == 0xfffffe00 + 1000); // not early
+  CHECK(slow_periodic(1000));
+  CHECK(sched_task(0)->overruns == 0);
+  CHECK(sched_task(0)->maxtime == 300);
+
+  // no room
+  sched_init(&fake_clock);
+  for (int i=0; i<SCHED_MAX_TASKS; i++)
+    CHECK(sched_add("fast", &fast, 0, 100, 0) == i);
+  CHECK(sched_add("fast", &fast, 0, 100, 0) == -1);
+  return check_done();
+}
@@ -0,0 +1,118 @@
+/**
+ * test_scurve.cpp
+ * S-curve ramps (motion.jerk): the peak acceleration and the jerk stay within their limits,
+ * also when the ramps do not fit in a block
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The acceleration and jerk are the 2nd and 3rd differences of the sampled x position.
+ */
+#include "sim.h"
+#include "planner.h"
+#include "check.h"
+
+#define MAXSAMPLES 10000
+
+static double xs[MAXSAMPLES];
+static int nsamples;
+
+static void record(const tSimSample *s)
+{
+  if ( nsamples < MAXSAMPLES )
+    xs[nsamples++] = s->x;
+}
+
+// re-initialize the planner with new limits
+static void setup(int scale, int speed, int accel, int jerk)
+{
+  cfg->xscale = cfg->yscale = scale;
+  cfg->speed = speed;
+  cfg->accel = accel;
+  cfg->jerk = jerk;
+  plan_init();
+}
+
+// lines along x to the positions [micron], sampled every h [usec]
+static void run(const int *x, int n, uint32_t h)
+{
+  nsamples = 0;
+  sim_sample(h, &record);
+  sim_write(7); sim_write(100); sim_write(10000); // 100% of motion.speed
+  for (int i=0; i<n; i++)
+  {
+    sim_write(1);
+    sim_write(x[i]);
+    sim_write(0);
+  }
+  sim_finish();
+  sim_run_until(sim_now + 5 * h); // a few samples at rest
+  sim_sample(0, NULL);
+}
+
+static double max_accel(double h)
+{
+  double m = 0;
+  for (int i=1; i<nsamples-1; i++)
+    m = fmax(m, fabs(xs[i+1] - 2*xs[i] + xs[i-1]) / (h*h));
+  return m;
+}
+
+static double max_jerk(double h)
+{
+  double m = 0;
+  for (int i=1; i<nsamples-2; i++)
+    m = fmax(m, fabs(xs[i+2] - 3*xs[i+1] + 3*xs[i] - xs[i-1]) / (h*h*h));
+  return m;
+}
+
+int main()
+{
+  sim_config(NULL);
+  sim_start();
+
+  // long line, acceleration limited: the peak (not the mean) reaches motion.accel
+  int line[] = { 40000 };
+  setup(1000000, 50, 1000, 100000);
+  run(line, 1, 10000);
+  CHECK_NEAR(max_accel(0.01), 1000, 70);
+
+  // long line, jerk limited: mean sqrt(5000*50/6) = 204, peak 306 mm/sec2
+  setup(1000000, 50, 1000, 5000);
+  run(line, 1, 20000);
+  CHECK_NEAR(max_accel(0.02), 306, 30);
+  CHECK(max_jerk(0.02) < 5000 * 1.25);
+
+  // 1 mm lines back and forth: the ramps never reach motion.speed. Peak speed 9.4 mm/sec
+  // (the two ramps just fit), mean acceleration 88.6, peak 133 mm/sec2
+  int shuttle[] = { 1000, 0, 1000, 0 };
+  setup(2000000, 50, 1000, 5000);
+  run(shuttle, 4, 10000);
+  CHECK_NEAR(max_accel(0.01), 133, 20);
+  CHECK(max_jerk(0.01) < 5000 * 1.25);
+
+  // a row of short collinear lines: the junction speeds are planned with the jerk limit
+  int row[20];
+  for (int i=0; i<20; i++)
+    row[i] = 1000 * (i+1);
+  setup(1000000, 50, 1000, 5000);
+  run(row, 20, 20000);
+  CHECK(max_accel(0.02) < 1000);
+  CHECK(max_jerk(0.02) < 5000 * 1.25);
+
+  return check_done();
+}
@@ -0,0 +1,83 @@
+/**
+ * test_sim.cpp
+ * The simulator itself: a job ends at its last position, files map to the SD directory.
+ * The other tasks keep running while the planner waits for room in a full queue.
+ *
+ * Copyright (c) 2026 The LaOS contributors
+ *
+ *   This file is part of the LaOS project (see: http://wiki.protospace.nl/index.php/LaOS)
+ *
+ *   LaOS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   LaOS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with LaOS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "sim.h"
+#include "planner.h"
+#include "LaosSched.h"
+#include "check.h"
+
+static int polls;
+
+static void poll()
+{
+  polls++;
+}
+
+int main()
+{
+  sim_config(NULL);
+  sim_start();
+
+  // three sides of a 10 x 5 mm rectangle at 100 mm/sec, then a move
+  int job[] = { 7, 100, 10000, 1, 10000, 0, 1, 10000, 5000, 1, 0, 5000, 0, 20000, 30000 };
+  uint64_t start = sim_now;
+  for (unsigned i=0; i<sizeof(job)/sizeof(job[0]); i++)
+    sim_write(job[i]);
+  sim_finish();
+
+  CHECK(actpos_x == 20000 * 200 / 1000);
+  CHECK(actpos_y == 30000 * 200 / 1000);
+  CHECK(actpos_z == 0);
+  CHECK(mot->queue() == 0);
+  CHECK(sim_now - start > 250000); // 25 mm of lines at 100 mm/sec, plus the move
+  CHECK(sim_now - start < 5000000); // stops at each corner, 100 mm/sec2
+
+  // more lines than the queue holds, without waiting for mot->ready()
+  tActionRequest a;
+  memset(&a, 0, sizeof(a));
+  a.ActionType = AT_MOVE;
+  a.target.feed_rate = 60 * 100;
+  sched_add("poll", &poll, 0, 100, SCHED_BACKGROUND);
+  for (int i=0; i<40; i++) // the queue holds 16 blocks
+  {
+    a.target.x = (i & 1 ? 10 : 20);
+    plan_buffer_line(&a);
+  }
+  CHECK(polls > 0);
+  sim_finish();
+
+  // "/sd/" and "/local/" are the SD directory
+  FILE *fp = fopen("/sd/test.txt", "w");
+  CHECK(fp != NULL);
+  if ( fp )
+  {
+    fputs("test", fp);
+    fclose(fp);
+  }
+  fp = fopen("/local/test.txt", "r");
+  CHECK(fp != NULL);
+  if ( fp )
+    fclose(fp);
+  CHECK(remove("/sd/test.txt") == 0);
+  return check_done();
+}
@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+"""
+tracedecode.py - decode a LaOS binary event trace (sys.trace) into a readable log
+
+usage: tracedecode.py [-H LaosTrace.h] dump.bin
+  the dump is trace.bin from the SD card, or a capture of the serial port
+  (text output in between the events is skipped)
+"""
+import os
+import re
+import struct
+import sys
+
+HEADER = os.path.join(os.path.dirname(__file__), '..', 'laser', 'LaosTrace', 'LaosTrace.h')
+EVENT = struct.Struct('<HHIiii')  # sync, id, time [usec], 3 arguments (tTraceEvent)
+
+
+def read_table(header):
+    """Event names and formats, in the order of the TRACE_TABLE in LaosTrace.h"""
+    src = open(header).read()
+    sync = int(re.search(r'#define\s+TRACE_SYNC\s+(0x[0-9A-Fa-f]+)', src).group(1), 16)
+    table = re.findall(r'EV\((\w+),\s*"([^"]*)"\)', src)
+    return sync, table
+
+
+def decode(data, sync, table):
+    marker = struct.pack('<H', sync)
+    pos = 0
+    while True:
+        pos = data.find(marker, pos)
+        if pos < 0 or pos + EVENT.size > len(data):
+            return
+        _, id, time, a, b, c = EVENT.unpack_from(data, pos)
+        if id >= len(table):  # not an event: sync pattern in other output
+            pos += 1
+            continue
+        name, fmt = table[id]
+        args = (a, b, c)[:fmt.count('%')]
+        yield '%10.3f %-16s %s' % (time / 1000.0, name, fmt % args)
+        pos += EVENT.size
+
+
+def main(argv):
+    header = HEADER
+    if len(argv) > 2 and argv[0] == '-H':
+        header = argv[1]
+        argv = argv[2:]
+    if len(argv) != 1:
+        sys.stderr.write(__doc__)
+        return 1
+    sync, table = read_table(header)
+    data = open(argv[0], 'rb').read()
+    for line in decode(data, sync, table):
+        print(line)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))